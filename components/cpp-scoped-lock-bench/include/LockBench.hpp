@@ -0,0 +1,220 @@
+/*
+ * LockBench.hpp
+ *  On-target microbenchmarks of the LockableObject mutex policies:
+ *
+ *      runLockBench<FreeRtosSharedMutex>("FreeRtosSharedMutex");
+ *
+ *  For one policy, measures
+ *   - uncontended read and write cost: acquire + release of a ReadAccess/WriteAccess, in CPU cycles.
+ *   - contended throughput: 1..maxWorkers tasks (spread over both cores) reading as fast as they can.
+ *   - mixed loads: maxWorkers tasks with a read:write ratio of 99:1, 90:10 and 50:50.
+ *  with p50/p99/max latency of every operation, in CPU cycles of the core that ran it.
+ *
+ *  Every result is one CSV line starting with "BENCH," (see printLockBenchHeader() for the columns), so the
+ *  monitor output of several runs (policies, IDF versions, sdkconfigs) can be grepped together and compared.
+ *  The protected object is a plain counter, so the numbers are the cost of the lock itself, including
+ *  CONFIG_SCOPED_LOCK_STATS / CONFIG_SCOPED_LOCK_WATCHDOG when enabled (printed in the "# config" line).
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "esp_cpu.h"
+#include "esp_idf_version.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "LockableObject.hpp"
+
+// CPU cycle counter of the calling core
+static inline __attribute__((always_inline)) uint32_t lockBenchCycles()
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    return esp_cpu_get_cycle_count();
+#else
+    return esp_cpu_get_ccount();
+#endif
+}
+
+// Latency samples of one task. Keeps the most recent `capacity` samples (so warm-up drops out) and the maximum of all.
+class LockBenchRecorder
+{
+public:
+    static constexpr std::size_t capacity = 1024;
+
+    void record(uint32_t cycles)
+    {
+        m_samples[m_count % capacity] = cycles;
+        m_count++;
+        m_max = std::max(m_max, cycles);
+    }
+
+    uint32_t count() const { return m_count; }
+    uint32_t max() const { return m_max; }
+    std::size_t size() const { return std::min<std::size_t>(m_count, capacity); }
+    const uint32_t *samples() const { return m_samples; }
+
+private:
+    uint32_t m_samples[capacity];
+    uint32_t m_count{0};
+    uint32_t m_max{0};
+};
+
+struct LockBenchResult
+{
+    const char *policy;
+    const char *scenario; // "uncontended-read", "uncontended-write", "readers", "mixed"
+    uint32_t workers;
+    uint32_t readPercent;
+    uint32_t ops;
+    uint32_t opsPerSec;
+    uint32_t p50Cycles;
+    uint32_t p99Cycles;
+    uint32_t maxCycles;
+};
+
+// Print the column names (and the build configuration as a "# config" line)
+void printLockBenchHeader();
+void printLockBenchResult(const LockBenchResult &result);
+
+// Fill in ops and the latency columns of `result` from the recorders of all workers
+void mergeLockBenchRecorders(const LockBenchRecorder *recorders, std::size_t count, LockBenchResult &result);
+
+struct LockBenchCounter
+{
+    uint32_t value;
+};
+
+template <typename mutexType>
+class LockBench
+{
+public:
+    using Manager = LockableObject<LockBenchCounter, mutexType>;
+
+    static constexpr uint32_t uncontendedOps = 10000;
+    static constexpr uint32_t runMs = 250; // per contended scenario
+    static constexpr uint32_t maxWorkers = 2 * portNUM_PROCESSORS;
+    static constexpr uint32_t mixedReadPercents[] = {99, 90, 50};
+
+    explicit LockBench(const char *policy) : m_policy{policy} {}
+
+    void runAll()
+    {
+        runUncontended(false);
+        runUncontended(true);
+        for (uint32_t workers = 1; workers <= maxWorkers; workers++)
+        {
+            runContended(workers, 100);
+        }
+        for (uint32_t readPercent : mixedReadPercents)
+        {
+            runContended(maxWorkers, readPercent);
+        }
+    }
+
+    void runUncontended(bool write)
+    {
+        std::unique_ptr<LockBenchRecorder> recorder{new LockBenchRecorder{}};
+        const int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < uncontendedOps; i++)
+        {
+            recorder->record(oneOp(write));
+        }
+        const int64_t elapsedUs = esp_timer_get_time() - start;
+
+        report(write ? "uncontended-write" : "uncontended-read", 1, write ? 0 : 100, recorder.get(), elapsedUs);
+    }
+
+    // `workers` tasks, alternating between the cores, for runMs
+    void runContended(uint32_t workers, uint32_t readPercent)
+    {
+        std::unique_ptr<LockBenchRecorder[]> recorders{new LockBenchRecorder[workers]};
+        Worker ctx[maxWorkers];
+        m_stop = false;
+        m_done = xSemaphoreCreateCounting(workers, 0);
+        for (uint32_t w = 0; w < workers; w++)
+        {
+            ctx[w] = Worker{this, &recorders[w], readPercent};
+            xTaskCreatePinnedToCore(workerFunc, "LockBench", 3072, &ctx[w], uxTaskPriorityGet(nullptr), nullptr, w % portNUM_PROCESSORS);
+        }
+        const int64_t start = esp_timer_get_time();
+        vTaskDelay(pdMS_TO_TICKS(runMs));
+        m_stop = true;
+        for (uint32_t w = 0; w < workers; w++)
+        {
+            xSemaphoreTake(m_done, portMAX_DELAY);
+        }
+        const int64_t elapsedUs = esp_timer_get_time() - start;
+        vSemaphoreDelete(m_done);
+
+        report(readPercent == 100 ? "readers" : "mixed", workers, readPercent, recorders.get(), elapsedUs);
+    }
+
+private:
+    struct Worker
+    {
+        LockBench *bench;
+        LockBenchRecorder *recorder;
+        uint32_t readPercent;
+    };
+
+    void report(const char *scenario, uint32_t workers, uint32_t readPercent, const LockBenchRecorder *recorders, int64_t elapsedUs)
+    {
+        LockBenchResult result{};
+        result.policy = m_policy;
+        result.scenario = scenario;
+        result.workers = workers;
+        result.readPercent = readPercent;
+        mergeLockBenchRecorders(recorders, workers, result);
+        result.opsPerSec = elapsedUs > 0 ? static_cast<uint32_t>(uint64_t(result.ops) * 1000000 / elapsedUs) : 0;
+        printLockBenchResult(result);
+    }
+
+    // acquire + release, in cycles
+    uint32_t oneOp(bool write)
+    {
+        const uint32_t start = lockBenchCycles();
+        if (write)
+        {
+            if (auto access = m_object.getWriteAccess())
+            {
+                access->value++;
+            }
+        }
+        else if (auto access = m_object.getReadAccess())
+        {
+            m_sink = access->value;
+        }
+        return lockBenchCycles() - start;
+    }
+
+    static void workerFunc(void *arg)
+    {
+        Worker &w = *static_cast<Worker *>(arg);
+        for (uint32_t i = 0; !w.bench->m_stop; i++)
+        {
+            w.recorder->record(w.bench->oneOp(i % 100 >= w.readPercent));
+        }
+        xSemaphoreGive(w.bench->m_done);
+        vTaskDelete(nullptr);
+    }
+
+    const char *m_policy;
+    Manager m_object{};
+    volatile uint32_t m_sink{0};
+    volatile bool m_stop{false};
+    SemaphoreHandle_t m_done{nullptr};
+};
+
+// Run the whole suite for one mutex policy
+template <typename mutexType>
+void runLockBench(const char *policy)
+{
+    std::unique_ptr<LockBench<mutexType>> bench{new LockBench<mutexType>(policy)};
+    bench->runAll();
+}
@@ -0,0 +1,294 @@
+/*
+ * LockScaling.hpp
+ *  Scaling matrix of the LockableObject mutex policies, checked against a stored baseline:
+ *
+ *      LockScalingOptions options{};           // the axes of the matrix and the tolerances, see below
+ *      uint32_t regressions = runLockScaling<FreeRtosSharedMutex>("FreeRtosSharedMutex", options,
+ *                                                                 baselines, std::size(baselines));
+ *
+ *  Every combination of the axes is one point: readers and writers tasks, pinned to the cores (spread, all on
+ *  core 0 or not pinned), the writers some priorities above the readers, each holding the lock for holdCycles.
+ *  For each point, the tasks take ReadAccess/WriteAccess with timeoutMs as fast as they can for runMs.
+ *
+ *  The throughput is compared as a percentage of the reference policy (std::shared_timed_mutex by default) at the
+ *  same point, measured in the same run (once per point, on its first use), so a faster or slower chip, CPU clock
+ *  or host machine doesn't shift it much. A point is a regression if its percentage is more than
+ *  maxSlowdownPercent below its baseline (of the same policy, IDF version, target and number of cores), or it times
+ *  out more than maxExtraTimeoutPerMille more often. Without a baseline, a point below minPercentOfReference is a
+ *  regression, the others only print their results. With reportOnly, the verdicts are printed and not counted.
+ *
+ *  Every point is one "SCALING," CSV line (see printLockScalingHeader()), followed by a baseline entry for it
+ *  as C++, so a new baseline is a grep of the monitor output:
+ *
+ *      grep -h '// BASELINE$' bench.log
+ *
+ *  The readers run one priority below the calling task, so it can stop them on time even on its own core. The
+ *  writers run writerPriority above the readers, but at most at the priority of the calling task.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "LockBench.hpp"
+#include "LockableObject.hpp"
+
+enum class LockScalingPinning : uint8_t
+{
+    Spread,   // task i on core i % portNUM_PROCESSORS, readers first
+    SameCore, // all on core 0
+    Unpinned, // tskNO_AFFINITY
+};
+
+struct LockScalingPoint
+{
+    uint8_t readers;
+    uint8_t writers;
+    LockScalingPinning pinning;
+    uint8_t writerPriority; // priorities of the writers above the readers
+    uint32_t holdCycles;    // CPU cycles spent in every read and write section
+};
+
+bool operator==(const LockScalingPoint &a, const LockScalingPoint &b);
+
+struct LockScalingResult
+{
+    const char *policy;
+    LockScalingPoint point;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t timeouts; // of reads and writes
+    uint32_t opsPerSec;
+    uint32_t timeoutPerMille;    // of all accesses tried
+    uint32_t percentOfReference; // opsPerSec relative to the reference policy at the same point
+};
+
+// The results of one point on one platform, as printed by printLockScalingResult()
+struct LockScalingBaseline
+{
+    const char *idf;    // a prefix of esp_get_idf_version(), i.e. "v5.4" or "v4.4" ("host" on the host)
+    const char *target; // CONFIG_IDF_TARGET
+    uint8_t cores;      // portNUM_PROCESSORS
+    const char *policy;
+    LockScalingPoint point;
+    uint32_t percentOfReference;
+    uint32_t timeoutPerMille;
+};
+
+struct LockScalingOptions
+{
+    // the axes
+    std::vector<uint8_t> readers{1, 4};
+    std::vector<uint8_t> writers{0, 1};
+    std::vector<LockScalingPinning> pinnings{LockScalingPinning::Spread, LockScalingPinning::SameCore};
+    std::vector<uint8_t> writerPriorities{0, 1}; // only the first one is used for points without writers
+    std::vector<uint32_t> holdCycles{0, 2000};
+
+    uint32_t runMs{50}; // per point
+    uint32_t timeoutMs{10};
+
+    // when a point is a regression
+    uint32_t maxSlowdownPercent{50};    // of percentOfReference
+    uint32_t maxExtraTimeoutPerMille{10};
+    uint32_t minPercentOfReference{25}; // for points without a baseline
+    bool reportOnly{false};             // print the verdicts, count no regressions
+};
+
+enum class LockScalingVerdict : uint8_t
+{
+    NoBaseline,
+    Ok,
+    Slower,
+    MoreTimeouts,
+};
+
+const char *lockScalingVerdictName(LockScalingVerdict verdict);
+
+// Every combination of the axes of `options`, in the order of the members
+std::vector<LockScalingPoint> lockScalingPoints(const LockScalingOptions &options);
+
+// The baseline of `policy` at `point` for the running platform, nullptr if `baselines` has none
+const LockScalingBaseline *findLockScalingBaseline(const LockScalingBaseline *baselines, std::size_t count,
+                                                   const char *policy, const LockScalingPoint &point);
+LockScalingVerdict checkLockScaling(const LockScalingResult &result, const LockScalingBaseline *baseline,
+                                    const LockScalingOptions &options);
+
+// Print the column names (and the "# config" line of printLockBenchHeader())
+void printLockScalingHeader();
+// The CSV line of `result`, and its baseline entry
+void printLockScalingResult(const LockScalingResult &result, LockScalingVerdict verdict);
+// Set result.percentOfReference
+void compareLockScaling(LockScalingResult &result, const LockScalingResult &reference);
+
+template <typename mutexType>
+class LockScaling
+{
+public:
+    using Manager = LockableObject<LockBenchCounter, mutexType>;
+
+    LockScaling(const char *policy, const LockScalingOptions &options)
+        : m_policy{policy}, m_options{options}, m_timeout{options.timeoutMs}
+    {
+    }
+
+    // All points of the matrix, reference(point) returns the LockScalingResult of the reference policy.
+    // Returns the number of regressions.
+    template <class Reference>
+    uint32_t runAll(const LockScalingBaseline *baselines, std::size_t count, Reference &&reference)
+    {
+        uint32_t regressions = 0;
+        for (const LockScalingPoint &point : lockScalingPoints(m_options))
+        {
+            const LockScalingResult referenceResult = reference(point); // before, so it doesn't run in between
+            LockScalingResult result = runPoint(point);
+            compareLockScaling(result, referenceResult);
+            const LockScalingVerdict verdict =
+                checkLockScaling(result, findLockScalingBaseline(baselines, count, m_policy, point), m_options);
+            printLockScalingResult(result, verdict);
+            const bool regression = verdict == LockScalingVerdict::Slower || verdict == LockScalingVerdict::MoreTimeouts;
+            regressions += (regression && !m_options.reportOnly) ? 1 : 0;
+        }
+        return regressions;
+    }
+
+    LockScalingResult runPoint(const LockScalingPoint &point)
+    {
+        const uint32_t workers = point.readers + point.writers;
+        std::unique_ptr<Worker[]> ctx{new Worker[workers]};
+        const UBaseType_t priority = uxTaskPriorityGet(nullptr);
+        const UBaseType_t readerPriority = priority > tskIDLE_PRIORITY ? priority - 1 : priority;
+        const UBaseType_t writerPriority = std::min<UBaseType_t>(readerPriority + point.writerPriority, priority);
+
+        m_holdCycles = point.holdCycles;
+        m_stop = false;
+        m_done = xSemaphoreCreateCounting(workers, 0);
+        for (uint32_t w = 0; w < workers; w++)
+        {
+            const bool write = w >= point.readers;
+            ctx[w] = Worker{this, write, 0, 0};
+            const BaseType_t core = point.pinning == LockScalingPinning::Spread     ? BaseType_t(w % portNUM_PROCESSORS)
+                                    : point.pinning == LockScalingPinning::SameCore ? 0
+                                                                                    : tskNO_AFFINITY;
+            xTaskCreatePinnedToCore(workerFunc, write ? "ScaleWrite" : "ScaleRead", 3072, &ctx[w],
+                                    write ? writerPriority : readerPriority, nullptr, core);
+        }
+        const int64_t start = esp_timer_get_time();
+        vTaskDelay(pdMS_TO_TICKS(m_options.runMs));
+        m_stop = true;
+        for (uint32_t w = 0; w < workers; w++)
+        {
+            xSemaphoreTake(m_done, portMAX_DELAY);
+        }
+        const int64_t elapsedUs = esp_timer_get_time() - start;
+        vSemaphoreDelete(m_done);
+
+        LockScalingResult result{};
+        result.policy = m_policy;
+        result.point = point;
+        for (uint32_t w = 0; w < workers; w++)
+        {
+            (ctx[w].write ? result.writes : result.reads) += ctx[w].ops;
+            result.timeouts += ctx[w].timeouts;
+        }
+        const uint64_t ops = uint64_t(result.reads) + result.writes;
+        result.opsPerSec = elapsedUs > 0 ? static_cast<uint32_t>(ops * 1000000 / elapsedUs) : 0;
+        result.timeoutPerMille = ops + result.timeouts > 0 ? static_cast<uint32_t>(uint64_t(result.timeouts) * 1000 / (ops + result.timeouts)) : 0;
+        return result;
+    }
+
+private:
+    struct Worker
+    {
+        LockScaling *bench;
+        bool write;
+        uint32_t ops;
+        uint32_t timeouts;
+    };
+
+    void hold() const
+    {
+        const uint32_t start = lockBenchCycles();
+        while (lockBenchCycles() - start < m_holdCycles)
+        {
+        }
+    }
+
+    // returns false if the access timed out
+    bool oneOp(bool write)
+    {
+        if (write)
+        {
+            if (auto access = m_object.getWriteAccess(m_timeout))
+            {
+                access->value++;
+                hold();
+                return true;
+            }
+        }
+        else if (auto access = m_object.getReadAccess(m_timeout))
+        {
+            m_sink = access->value;
+            hold();
+            return true;
+        }
+        return false;
+    }
+
+    static void workerFunc(void *arg)
+    {
+        Worker &w = *static_cast<Worker *>(arg);
+        while (!w.bench->m_stop)
+        {
+            (w.bench->oneOp(w.write) ? w.ops : w.timeouts)++;
+        }
+        xSemaphoreGive(w.bench->m_done);
+        vTaskDelete(nullptr);
+    }
+
+    const char *m_policy;
+    const LockScalingOptions &m_options;
+    const std::chrono::milliseconds m_timeout;
+    Manager m_object{};
+    uint32_t m_holdCycles{0};
+    volatile uint32_t m_sink{0};
+    volatile bool m_stop{false};
+    SemaphoreHandle_t m_done{nullptr};
+};
+
+// The result of the reference policy at `point`. Measured on the first call for a point, then the same one for the
+// rest of the run (the options of the first call count).
+template <typename referenceMutex>
+LockScalingResult lockScalingReference(const LockScalingOptions &options, const LockScalingPoint &point)
+{
+    static std::vector<LockScalingResult> s_measured;
+    for (const LockScalingResult &r : s_measured)
+    {
+        if (r.point == point)
+        {
+            return r;
+        }
+    }
+    std::unique_ptr<LockScaling<referenceMutex>> scaling{new LockScaling<referenceMutex>("reference", options)};
+    s_measured.push_back(scaling->runPoint(point));
+    return s_measured.back();
+}
+
+// Run the whole matrix for one mutex policy, returns the number of regressions against `baselines`
+template <typename mutexType, typename referenceMutex = std::shared_timed_mutex>
+uint32_t runLockScaling(const char *policy, const LockScalingOptions &options, const LockScalingBaseline *baselines,
+                        std::size_t count)
+{
+    std::unique_ptr<LockScaling<mutexType>> scaling{new LockScaling<mutexType>(policy, options)};
+    return scaling->runAll(baselines, count, [&options](const LockScalingPoint &point) {
+        return lockScalingReference<referenceMutex>(options, point);
+    });
+}
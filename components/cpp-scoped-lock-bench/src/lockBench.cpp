@@ -0,0 +1,69 @@
+/*
+ * lockBench.cpp
+ *  Merging and printing of the lock benchmark results.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include "esp_rom_sys.h"
+#include "esp_system.h"
+#include "LockBench.hpp"
+
+#if CONFIG_SCOPED_LOCK_STATS
+static constexpr int statsEnabled = 1;
+#else
+static constexpr int statsEnabled = 0;
+#endif
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+static constexpr int watchdogEnabled = 1;
+#else
+static constexpr int watchdogEnabled = 0;
+#endif
+
+void printLockBenchHeader()
+{
+    printf("# config idf=%s cores=%d cpu_mhz=%u stats=%d watchdog=%d\n", esp_get_idf_version(), portNUM_PROCESSORS,
+           (unsigned)esp_rom_get_cpu_ticks_per_us(), statsEnabled, watchdogEnabled);
+    printf("BENCH,idf,policy,scenario,workers,read_percent,ops,ops_per_sec,p50_cycles,p99_cycles,max_cycles\n");
+}
+
+void printLockBenchResult(const LockBenchResult &r)
+{
+    printf("BENCH,%s,%s,%s,%u,%u,%u,%u,%u,%u,%u\n", esp_get_idf_version(), r.policy, r.scenario, (unsigned)r.workers,
+           (unsigned)r.readPercent, (unsigned)r.ops, (unsigned)r.opsPerSec, (unsigned)r.p50Cycles, (unsigned)r.p99Cycles,
+           (unsigned)r.maxCycles);
+}
+
+void mergeLockBenchRecorders(const LockBenchRecorder *recorders, std::size_t count, LockBenchResult &result)
+{
+    std::size_t total = 0;
+    result.ops = 0;
+    result.maxCycles = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        total += recorders[i].size();
+        result.ops += recorders[i].count();
+        result.maxCycles = std::max(result.maxCycles, recorders[i].max());
+    }
+    if (total == 0)
+    {
+        result.p50Cycles = result.p99Cycles = 0;
+        return;
+    }
+
+    std::unique_ptr<uint32_t[]> merged{new uint32_t[total]};
+    uint32_t *out = merged.get();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        out = std::copy(recorders[i].samples(), recorders[i].samples() + recorders[i].size(), out);
+    }
+    auto percentile = [&](std::size_t perMille) {
+        uint32_t *nth = merged.get() + std::min(total - 1, total * perMille / 1000);
+        std::nth_element(merged.get(), nth, merged.get() + total);
+        return *nth;
+    };
+    result.p50Cycles = percentile(500);
+    result.p99Cycles = percentile(990);
+}
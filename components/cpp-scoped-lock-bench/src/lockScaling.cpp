@@ -0,0 +1,138 @@
+/*
+ * lockScaling.cpp
+ *  Points, baseline comparison and printing of the lock scaling matrix.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "esp_system.h"
+#include "sdkconfig.h"
+#include "LockScaling.hpp"
+
+static const char *pinningName(LockScalingPinning pinning)
+{
+    switch (pinning)
+    {
+    case LockScalingPinning::Spread:
+        return "Spread";
+    case LockScalingPinning::SameCore:
+        return "SameCore";
+    case LockScalingPinning::Unpinned:
+        return "Unpinned";
+    }
+    return "?";
+}
+
+bool operator==(const LockScalingPoint &a, const LockScalingPoint &b)
+{
+    return a.readers == b.readers && a.writers == b.writers && a.pinning == b.pinning &&
+           a.writerPriority == b.writerPriority && a.holdCycles == b.holdCycles;
+}
+
+const char *lockScalingVerdictName(LockScalingVerdict verdict)
+{
+    switch (verdict)
+    {
+    case LockScalingVerdict::NoBaseline:
+        return "no-baseline";
+    case LockScalingVerdict::Ok:
+        return "ok";
+    case LockScalingVerdict::Slower:
+        return "SLOWER";
+    case LockScalingVerdict::MoreTimeouts:
+        return "MORE-TIMEOUTS";
+    }
+    return "?";
+}
+
+std::vector<LockScalingPoint> lockScalingPoints(const LockScalingOptions &options)
+{
+    std::vector<LockScalingPoint> points;
+    for (uint8_t readers : options.readers)
+    {
+        for (uint8_t writers : options.writers)
+        {
+            for (LockScalingPinning pinning : options.pinnings)
+            {
+                for (uint8_t writerPriority : options.writerPriorities)
+                {
+                    // without writers, their priority doesn't matter
+                    if (readers + writers == 0 || (writers == 0 && writerPriority != options.writerPriorities.front()))
+                    {
+                        continue;
+                    }
+                    for (uint32_t holdCycles : options.holdCycles)
+                    {
+                        points.push_back(LockScalingPoint{readers, writers, pinning, writerPriority, holdCycles});
+                    }
+                }
+            }
+        }
+    }
+    return points;
+}
+
+const LockScalingBaseline *findLockScalingBaseline(const LockScalingBaseline *baselines, std::size_t count,
+                                                   const char *policy, const LockScalingPoint &point)
+{
+    const char *idf = esp_get_idf_version();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const LockScalingBaseline &b = baselines[i];
+        if (b.cores == portNUM_PROCESSORS && std::strncmp(idf, b.idf, std::strlen(b.idf)) == 0 &&
+            std::strcmp(b.target, CONFIG_IDF_TARGET) == 0 && std::strcmp(b.policy, policy) == 0 && b.point == point)
+        {
+            return &b;
+        }
+    }
+    return nullptr;
+}
+
+LockScalingVerdict checkLockScaling(const LockScalingResult &result, const LockScalingBaseline *baseline,
+                                    const LockScalingOptions &options)
+{
+    if (!baseline)
+    {
+        return result.percentOfReference < options.minPercentOfReference ? LockScalingVerdict::Slower
+                                                                          : LockScalingVerdict::NoBaseline;
+    }
+    if (uint64_t(result.percentOfReference) * 100 <
+        uint64_t(baseline->percentOfReference) * (100 - std::min<uint32_t>(options.maxSlowdownPercent, 100)))
+    {
+        return LockScalingVerdict::Slower;
+    }
+    if (result.timeoutPerMille > baseline->timeoutPerMille + options.maxExtraTimeoutPerMille)
+    {
+        return LockScalingVerdict::MoreTimeouts;
+    }
+    return LockScalingVerdict::Ok;
+}
+
+void printLockScalingHeader()
+{
+    printLockBenchHeader();
+    printf("SCALING,idf,target,policy,readers,writers,pinning,writer_priority,hold_cycles,reads,writes,timeouts,"
+           "ops_per_sec,timeout_per_mille,percent_of_reference,verdict\n");
+}
+
+void printLockScalingResult(const LockScalingResult &r, LockScalingVerdict verdict)
+{
+    const LockScalingPoint &p = r.point;
+    printf("SCALING,%s,%s,%s,%u,%u,%s,%u,%u,%u,%u,%u,%u,%u,%u,%s\n", esp_get_idf_version(), CONFIG_IDF_TARGET, r.policy,
+           (unsigned)p.readers, (unsigned)p.writers, pinningName(p.pinning), (unsigned)p.writerPriority,
+           (unsigned)p.holdCycles, (unsigned)r.reads, (unsigned)r.writes, (unsigned)r.timeouts, (unsigned)r.opsPerSec,
+           (unsigned)r.timeoutPerMille, (unsigned)r.percentOfReference, lockScalingVerdictName(verdict));
+    printf("    {\"%s\", \"%s\", %d, \"%s\", {%u, %u, LockScalingPinning::%s, %u, %u}, %u, %u}, // BASELINE\n",
+           esp_get_idf_version(), CONFIG_IDF_TARGET, portNUM_PROCESSORS, r.policy, (unsigned)p.readers,
+           (unsigned)p.writers, pinningName(p.pinning), (unsigned)p.writerPriority, (unsigned)p.holdCycles,
+           (unsigned)r.percentOfReference, (unsigned)r.timeoutPerMille);
+}
+
+void compareLockScaling(LockScalingResult &result, const LockScalingResult &reference)
+{
+    // a reference that got nothing done gives nothing to compare with
+    result.percentOfReference = reference.opsPerSec > 0
+                                    ? static_cast<uint32_t>(uint64_t(result.opsPerSec) * 100 / reference.opsPerSec)
+                                    : 100;
+}
@@ -0,0 +1,48 @@
+/*
+  Lock microbenchmarks, one test case per mutex policy. Grep the monitor output for "BENCH," to get the results as CSV.
+*/
+
+#include "unity.h"
+#include "LockBench.hpp"
+#include "AdaptiveSpinMutex.hpp"
+#include "FairSharedMutex.hpp"
+#include "FreeRtosSharedMutex.hpp"
+#include "PerCoreSharedMutex.hpp"
+#include "UpgradableMutex.hpp"
+
+#define TAG "[bench]"
+
+TEST_CASE("LockBench header", TAG)
+{
+    printLockBenchHeader();
+}
+
+TEST_CASE("LockBench std::shared_timed_mutex", TAG)
+{
+    runLockBench<std::shared_timed_mutex>("std::shared_timed_mutex");
+}
+
+TEST_CASE("LockBench FreeRtosSharedMutex", TAG)
+{
+    runLockBench<FreeRtosSharedMutex>("FreeRtosSharedMutex");
+}
+
+TEST_CASE("LockBench PerCoreSharedMutex", TAG)
+{
+    runLockBench<PerCoreSharedMutex>("PerCoreSharedMutex");
+}
+
+TEST_CASE("LockBench PhaseFairSharedMutex", TAG)
+{
+    runLockBench<PhaseFairSharedMutex>("PhaseFairSharedMutex");
+}
+
+TEST_CASE("LockBench AdaptiveSpinMutex", TAG)
+{
+    runLockBench<AdaptiveSpinMutex<>>("AdaptiveSpinMutex<FreeRtosSharedMutex>");
+}
+
+TEST_CASE("LockBench UpgradableMutex", TAG)
+{
+    runLockBench<UpgradableMutex<FreeRtosSharedMutex, FreeRtosSharedMutex>>("UpgradableMutex<FreeRtosSharedMutex>");
+}
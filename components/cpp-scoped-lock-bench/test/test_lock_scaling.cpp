@@ -0,0 +1,267 @@
+/*
+  Lock scaling matrix, one test case per mutex policy. Fails on a regression against the baselines below, which are
+  relative to std::shared_timed_mutex measured in the same run.
+  Grep the monitor output for "SCALING," to get the results as CSV, and for "// BASELINE" to refresh the baselines.
+*/
+
+#include <iterator>
+
+#include "esp_system.h"
+#include "unity.h"
+#include "LockScaling.hpp"
+#include "AdaptiveSpinMutex.hpp"
+#include "FairSharedMutex.hpp"
+#include "FreeRtosSharedMutex.hpp"
+#include "PerCoreSharedMutex.hpp"
+#include "UpgradableMutex.hpp"
+
+#define TAG "[bench]"
+
+// The points of the platforms listed here are checked against their baseline, the others only against
+// minPercentOfReference. The targets await a run on the hardware: paste its "// BASELINE" lines here.
+static const LockScalingBaseline s_baselines[] = {
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 0, LockScalingPinning::Spread, 0, 0}, 98, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 0, LockScalingPinning::Spread, 0, 2000}, 100, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 0, LockScalingPinning::SameCore, 0, 0}, 98, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 0, LockScalingPinning::SameCore, 0, 2000}, 98, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::Spread, 0, 0}, 97, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::Spread, 0, 2000}, 101, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::Spread, 1, 0}, 99, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::Spread, 1, 2000}, 91, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::SameCore, 0, 0}, 99, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::SameCore, 0, 2000}, 99, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::SameCore, 1, 0}, 101, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {1, 1, LockScalingPinning::SameCore, 1, 2000}, 100, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 0, LockScalingPinning::Spread, 0, 0}, 108, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 0, LockScalingPinning::Spread, 0, 2000}, 98, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 0, LockScalingPinning::SameCore, 0, 0}, 100, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 0, LockScalingPinning::SameCore, 0, 2000}, 99, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::Spread, 0, 0}, 100, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::Spread, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::Spread, 1, 0}, 101, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::Spread, 1, 2000}, 99, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::SameCore, 0, 0}, 102, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::SameCore, 0, 2000}, 98, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::SameCore, 1, 0}, 33, 0},
+    {"host", "linux", 2, "std::shared_timed_mutex", {4, 1, LockScalingPinning::SameCore, 1, 2000}, 99, 0},
+
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 0, LockScalingPinning::Spread, 0, 0}, 109, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 0, LockScalingPinning::Spread, 0, 2000}, 105, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 0, LockScalingPinning::SameCore, 0, 0}, 113, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 0, LockScalingPinning::SameCore, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::Spread, 0, 0}, 92, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::Spread, 0, 2000}, 99, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::Spread, 1, 0}, 90, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::Spread, 1, 2000}, 99, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::SameCore, 0, 0}, 95, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::SameCore, 0, 2000}, 100, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::SameCore, 1, 0}, 98, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {1, 1, LockScalingPinning::SameCore, 1, 2000}, 98, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 0, LockScalingPinning::Spread, 0, 0}, 124, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 0, LockScalingPinning::Spread, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 0, LockScalingPinning::SameCore, 0, 0}, 111, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 0, LockScalingPinning::SameCore, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::Spread, 0, 0}, 102, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::Spread, 0, 2000}, 107, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::Spread, 1, 0}, 102, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::Spread, 1, 2000}, 103, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::SameCore, 0, 0}, 106, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::SameCore, 0, 2000}, 101, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::SameCore, 1, 0}, 104, 0},
+    {"host", "linux", 2, "FreeRtosSharedMutex", {4, 1, LockScalingPinning::SameCore, 1, 2000}, 102, 0},
+
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 0, LockScalingPinning::Spread, 0, 0}, 104, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 0, LockScalingPinning::Spread, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 0, LockScalingPinning::SameCore, 0, 0}, 85, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 0, LockScalingPinning::SameCore, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::Spread, 0, 0}, 94, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::Spread, 0, 2000}, 84, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::Spread, 1, 0}, 99, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::Spread, 1, 2000}, 79, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::SameCore, 0, 0}, 96, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::SameCore, 0, 2000}, 80, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::SameCore, 1, 0}, 99, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {1, 1, LockScalingPinning::SameCore, 1, 2000}, 78, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 0, LockScalingPinning::Spread, 0, 0}, 131, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 0, LockScalingPinning::Spread, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 0, LockScalingPinning::SameCore, 0, 0}, 115, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 0, LockScalingPinning::SameCore, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::Spread, 0, 0}, 115, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::Spread, 0, 2000}, 110, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::Spread, 1, 0}, 120, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::Spread, 1, 2000}, 106, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::SameCore, 0, 0}, 118, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::SameCore, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::SameCore, 1, 0}, 113, 0},
+    {"host", "linux", 2, "PerCoreSharedMutex", {4, 1, LockScalingPinning::SameCore, 1, 2000}, 102, 0},
+
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 0, LockScalingPinning::Spread, 0, 0}, 104, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 0, LockScalingPinning::Spread, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 0, LockScalingPinning::SameCore, 0, 0}, 112, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 0, LockScalingPinning::SameCore, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::Spread, 0, 0}, 100, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::Spread, 0, 2000}, 105, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::Spread, 1, 0}, 122, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::Spread, 1, 2000}, 99, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::SameCore, 0, 0}, 114, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::SameCore, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::SameCore, 1, 0}, 117, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {1, 1, LockScalingPinning::SameCore, 1, 2000}, 103, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 0, LockScalingPinning::Spread, 0, 0}, 122, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 0, LockScalingPinning::Spread, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 0, LockScalingPinning::SameCore, 0, 0}, 111, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 0, LockScalingPinning::SameCore, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::Spread, 0, 0}, 106, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::Spread, 0, 2000}, 109, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::Spread, 1, 0}, 103, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::Spread, 1, 2000}, 51, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::SameCore, 0, 0}, 80, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::SameCore, 0, 2000}, 102, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::SameCore, 1, 0}, 72, 0},
+    {"host", "linux", 2, "PhaseFairSharedMutex", {4, 1, LockScalingPinning::SameCore, 1, 2000}, 39, 0},
+
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::Spread, 0, 0}, 50, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::Spread, 0, 2000}, 51, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::SameCore, 0, 0}, 56, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::SameCore, 0, 2000}, 62, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 0, 0}, 63, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 0, 2000}, 92, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 1, 0}, 96, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 1, 2000}, 74, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 0, 0}, 97, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 0, 2000}, 99, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 1, 0}, 98, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 1, 2000}, 97, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::Spread, 0, 0}, 117, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::Spread, 0, 2000}, 81, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::SameCore, 0, 0}, 69, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::SameCore, 0, 2000}, 102, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 0, 0}, 105, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 0, 2000}, 107, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 1, 0}, 70, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 1, 2000}, 49, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 0, 0}, 107, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 0, 2000}, 99, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 1, 0}, 105, 0},
+    {"host", "linux", 2, "AdaptiveSpinMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 1, 2000}, 101, 0},
+
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::Spread, 0, 0}, 104, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::Spread, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::SameCore, 0, 0}, 112, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 0, LockScalingPinning::SameCore, 0, 2000}, 103, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 0, 0}, 85, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 0, 2000}, 93, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 1, 0}, 85, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::Spread, 1, 2000}, 92, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 0, 0}, 79, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 0, 2000}, 94, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 1, 0}, 86, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {1, 1, LockScalingPinning::SameCore, 1, 2000}, 88, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::Spread, 0, 0}, 127, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::Spread, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::SameCore, 0, 0}, 111, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 0, LockScalingPinning::SameCore, 0, 2000}, 101, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 0, 0}, 96, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 0, 2000}, 104, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 1, 0}, 95, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::Spread, 1, 2000}, 79, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 0, 0}, 104, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 0, 2000}, 99, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 1, 0}, 98, 0},
+    {"host", "linux", 2, "UpgradableMutex<FreeRtosSharedMutex>", {4, 1, LockScalingPinning::SameCore, 1, 2000}, 98, 0},
+};
+
+static LockScalingOptions scalingOptions()
+{
+    LockScalingOptions options{};
+#if CONFIG_IDF_TARGET_LINUX
+    // The host threads share the CPUs of the machine (and its scheduler, which ignores the priorities), so even the
+    // ratios depend on the machine and its load: the host only reports.
+    options.reportOnly = true;
+#endif
+    return options;
+}
+
+template <typename mutexType>
+static void checkScaling(const char *policy)
+{
+    const LockScalingOptions options = scalingOptions();
+    const uint32_t regressions = runLockScaling<mutexType>(policy, options, s_baselines, std::size(s_baselines));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, regressions, "Expected no point slower or timing out more than its baseline.");
+}
+
+TEST_CASE("LockScaling header", TAG)
+{
+    printLockScalingHeader();
+}
+
+TEST_CASE("LockScaling points and verdicts", TAG)
+{
+    LockScalingOptions options{};
+    options.readers = {2};
+    options.writers = {0, 1};
+    options.pinnings = {LockScalingPinning::Spread};
+    options.writerPriorities = {0, 1, 2};
+    options.holdCycles = {0, 100};
+    TEST_ASSERT_EQUAL_MESSAGE(2 + 6, lockScalingPoints(options).size(), "Expected one writer priority without writers.");
+
+    const LockScalingPoint point{2, 1, LockScalingPinning::Spread, 1, 100};
+    const LockScalingBaseline baselines[] = {
+        {esp_get_idf_version(), CONFIG_IDF_TARGET, portNUM_PROCESSORS, "other", point, 1, 0},
+        {esp_get_idf_version(), CONFIG_IDF_TARGET, portNUM_PROCESSORS, "test", point, 200, 5},
+    };
+    TEST_ASSERT_NULL(findLockScalingBaseline(baselines, std::size(baselines), "test", LockScalingPoint{2, 1, LockScalingPinning::Spread, 0, 100}));
+    const LockScalingBaseline *baseline = findLockScalingBaseline(baselines, std::size(baselines), "test", point);
+    TEST_ASSERT_TRUE(baseline == &baselines[1]);
+
+    options.maxSlowdownPercent = 50;
+    options.maxExtraTimeoutPerMille = 10;
+    options.minPercentOfReference = 25;
+    LockScalingResult result{"test", point, 0, 0, 0, 500, 15, 0};
+    // the throughput counts relative to the reference at the same point, not absolute
+    compareLockScaling(result, LockScalingResult{"reference", point, 0, 0, 0, 250, 0, 0});
+    TEST_ASSERT_EQUAL_UINT32(200, result.percentOfReference);
+    TEST_ASSERT_EQUAL(LockScalingVerdict::Ok, checkLockScaling(result, baseline, options));
+    result.percentOfReference = 100;
+    TEST_ASSERT_EQUAL(LockScalingVerdict::Ok, checkLockScaling(result, baseline, options));
+    result.percentOfReference = 99;
+    TEST_ASSERT_EQUAL(LockScalingVerdict::Slower, checkLockScaling(result, baseline, options));
+    result.percentOfReference = 400;
+    result.timeoutPerMille = 16;
+    TEST_ASSERT_EQUAL(LockScalingVerdict::MoreTimeouts, checkLockScaling(result, baseline, options));
+
+    // without a baseline, only below minPercentOfReference
+    TEST_ASSERT_EQUAL(LockScalingVerdict::NoBaseline, checkLockScaling(result, nullptr, options));
+    result.percentOfReference = 24;
+    TEST_ASSERT_EQUAL(LockScalingVerdict::Slower, checkLockScaling(result, nullptr, options));
+}
+
+TEST_CASE("LockScaling std::shared_timed_mutex", TAG)
+{
+    checkScaling<std::shared_timed_mutex>("std::shared_timed_mutex");
+}
+
+TEST_CASE("LockScaling FreeRtosSharedMutex", TAG)
+{
+    checkScaling<FreeRtosSharedMutex>("FreeRtosSharedMutex");
+}
+
+TEST_CASE("LockScaling PerCoreSharedMutex", TAG)
+{
+    checkScaling<PerCoreSharedMutex>("PerCoreSharedMutex");
+}
+
+TEST_CASE("LockScaling PhaseFairSharedMutex", TAG)
+{
+    checkScaling<PhaseFairSharedMutex>("PhaseFairSharedMutex");
+}
+
+TEST_CASE("LockScaling AdaptiveSpinMutex", TAG)
+{
+    checkScaling<AdaptiveSpinMutex<>>("AdaptiveSpinMutex<FreeRtosSharedMutex>");
+}
+
+TEST_CASE("LockScaling UpgradableMutex", TAG)
+{
+    checkScaling<UpgradableMutex<FreeRtosSharedMutex, FreeRtosSharedMutex>>("UpgradableMutex<FreeRtosSharedMutex>");
+}
@@ -0,0 +1,227 @@
+/*
+ * AdaptiveSpinMutex.hpp
+ *  Mutex policy that spins briefly on a busy lock before blocking, for objects with very short critical sections:
+ *
+ *      using MyConfigDbSpinManager = LockableObject<MyConfigDb, AdaptiveSpinMutex<>>;
+ *
+ *  Wraps another policy (the inner mutex, FreeRtosSharedMutex by default; PerCoreSharedMutex works too, also
+ *  under UpgradableMutex<AdaptiveSpinMutex<PerCoreSharedMutex>>, since reads go through the inner LockTraits).
+ *  When a timed acquisition finds the lock busy, it retries the inner mutex's non-blocking path with exponentially
+ *  growing pauses in between, and only when the spin budget is used up, falls back to the inner blocking wait.
+ *  A holder running on the other core usually leaves within that time, which saves the block, the context switch
+ *  and the wake-up latency.
+ *
+ *  The spin budget (in pause iterations, about one CPU cycle each) is either fixed (the fixedSpins template argument),
+ *  or learned per instance and per side (fixedSpins = 0, the default), like glibc's adaptive mutex: each acquisition
+ *  spins up to twice the running average that spinning took to succeed (+ a small floor), capped at
+ *  CONFIG_SCOPED_LOCK_SPIN_MAX. Failed spins shrink the average, so an object with long holds soon stops spinning.
+ *
+ *  Spinning only helps while the holder runs on another core, so single-core builds (CONFIG_FREERTOS_UNICORE)
+ *  never spin. Zero timeouts (try-locks) never spin either.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+#include "FreeRtosSharedMutex.hpp"
+#include "LockableObject.hpp"
+
+#ifndef CONFIG_SCOPED_LOCK_SPIN_MAX
+#define CONFIG_SCOPED_LOCK_SPIN_MAX 400
+#endif
+
+template <typename innerMutexType = FreeRtosSharedMutex, uint32_t fixedSpins = 0>
+class AdaptiveSpinMutex
+{
+public:
+    using inner_type = innerMutexType;
+
+#if CONFIG_FREERTOS_UNICORE
+    static constexpr bool spinning = false;
+#else
+    static constexpr bool spinning = true;
+#endif
+    static constexpr uint32_t maxSpins = CONFIG_SCOPED_LOCK_SPIN_MAX;
+    static constexpr uint32_t minSpins = 10; // floor of the learned budget, so it can recover
+    static constexpr uint32_t maxPause = 32; // longest pause between two attempts
+
+    //-- Exclusive (writer) side. Same interface as std::shared_timed_mutex, so std::unique_lock works.
+
+    void lock()
+    {
+        spinThenBlock(true, true, [this] { return LockTraits<inner_type>::tryLock(m_inner, zero); },
+                      [this] { m_inner.lock(); return true; });
+    }
+    bool try_lock() { return LockTraits<inner_type>::tryLock(m_inner, zero); }
+
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return spinThenBlock(true, timeout_duration > timeout_duration.zero(),
+                             [this] { return LockTraits<inner_type>::tryLock(m_inner, zero); },
+                             [&] { return LockTraits<inner_type>::tryLock(m_inner, timeout_duration); });
+    }
+
+    void unlock() { LockTraits<inner_type>::unlock(m_inner); }
+
+    //-- Shared (reader) side, for inner mutexes with the std::shared_timed_mutex interface (std::shared_lock works).
+    //   Other policies go through LockTraits<AdaptiveSpinMutex> below.
+
+    bool try_lock_shared() { return m_inner.try_lock_shared(); }
+
+    template <class Rep, class Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        typename LockTraits<inner_type>::read_token token{};
+        return tryLockShared(timeout_duration, token);
+    }
+
+    void unlock_shared() { m_inner.unlock_shared(); }
+
+    // Shared acquisition through the inner policy's LockTraits
+    template <class Rep, class Period>
+    bool tryLockShared(const std::chrono::duration<Rep, Period> &timeout_duration, typename LockTraits<inner_type>::read_token &token)
+    {
+        return spinThenBlock(false, timeout_duration > timeout_duration.zero(),
+                             [&] { return LockTraits<inner_type>::tryLockShared(m_inner, zero, token); },
+                             [&] { return LockTraits<inner_type>::tryLockShared(m_inner, timeout_duration, token); });
+    }
+
+    inner_type &inner() { return m_inner; }
+
+    // The current spin budget of each side (pause iterations)
+    uint32_t spinBudget(bool write) const
+    {
+        if (!spinning)
+        {
+            return 0;
+        }
+        if (fixedSpins)
+        {
+            return fixedSpins;
+        }
+        const uint32_t average = (write ? m_writeSpins : m_readSpins).load(std::memory_order_relaxed);
+        return std::min(maxSpins, 2 * average + minSpins);
+    }
+
+private:
+    static constexpr std::chrono::milliseconds zero{0};
+
+    static inline __attribute__((always_inline)) void pause(uint32_t iterations)
+    {
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            __asm__ __volatile__("nop");
+        }
+    }
+
+    template <class TryOnce, class Block>
+    bool spinThenBlock(bool write, bool mayWait, TryOnce &&tryOnce, Block &&block)
+    {
+        if (tryOnce())
+        {
+            return true;
+        }
+        if (!spinning || !mayWait)
+        {
+            return mayWait && block();
+        }
+        std::atomic<uint32_t> &average = write ? m_writeSpins : m_readSpins;
+        const uint32_t budget = spinBudget(write);
+        uint32_t spun = 0;
+        for (uint32_t step = 1; spun < budget; step = std::min(step * 2, maxPause))
+        {
+            pause(step);
+            spun += step;
+            if (tryOnce())
+            {
+                learn(average, spun, true);
+                return true;
+            }
+        }
+        learn(average, spun, false);
+        return block();
+    }
+
+    // Move the running average 1/8 towards the spins it took, or 1/8 towards zero when spinning didn't help.
+    // Racy read-modify-write on purpose: a lost update only costs a slightly off estimate.
+    static void learn(std::atomic<uint32_t> &average, uint32_t spun, bool succeeded)
+    {
+        if (fixedSpins)
+        {
+            return;
+        }
+        const int32_t prev = static_cast<int32_t>(average.load(std::memory_order_relaxed));
+        const int32_t target = succeeded ? static_cast<int32_t>(spun) : 0;
+        average.store(static_cast<uint32_t>(prev + (target - prev) / 8), std::memory_order_relaxed);
+    }
+
+    inner_type m_inner{};
+    std::atomic<uint32_t> m_readSpins{maxSpins / 4};
+    std::atomic<uint32_t> m_writeSpins{maxSpins / 4};
+};
+
+template <typename innerMutexType, uint32_t fixedSpins>
+struct LockTraits<AdaptiveSpinMutex<innerMutexType, fixedSpins>>
+{
+    using mutex_type = AdaptiveSpinMutex<innerMutexType, fixedSpins>;
+    using write_lock = std::unique_lock<mutex_type>;
+
+    using read_token = typename LockTraits<innerMutexType>::read_token;
+
+    // Spins like a ReadAccess, and keeps the inner policy's read_token (i.e. the slot of a PerCoreSharedMutex),
+    // so it works for every inner mutex, not only those with the std::shared_timed_mutex interface
+    class read_lock
+    {
+    public:
+        template <class Rep, class Period>
+        read_lock(mutex_type &m, const std::chrono::duration<Rep, Period> &timeout_duration) : m_mutex{&m}
+        {
+            m_owns = m.tryLockShared(timeout_duration, m_token);
+        }
+
+        ~read_lock()
+        {
+            if (m_owns)
+            {
+                LockTraits<innerMutexType>::unlockShared(m_mutex->inner(), m_token);
+            }
+        }
+
+        read_lock(read_lock &&other) noexcept : m_mutex{other.m_mutex}, m_token{other.m_token}, m_owns{other.m_owns}
+        {
+            other.m_owns = false;
+        }
+        read_lock(const read_lock &) = delete;
+        read_lock &operator=(const read_lock &) = delete;
+
+        bool owns_lock() const noexcept { return m_owns; }
+
+    private:
+        mutex_type *m_mutex;
+        read_token m_token{};
+        bool m_owns{false};
+    };
+
+    template <class Rep, class Period>
+    static bool tryLock(mutex_type &m, const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return m.try_lock_for(timeout_duration);
+    }
+    static void unlock(mutex_type &m) { m.unlock(); }
+
+    template <class Rep, class Period>
+    static bool tryLockShared(mutex_type &m, const std::chrono::duration<Rep, Period> &timeout_duration, read_token &token)
+    {
+        return m.tryLockShared(timeout_duration, token);
+    }
+    static void unlockShared(mutex_type &m, read_token &token)
+    {
+        LockTraits<innerMutexType>::unlockShared(m.inner(), token);
+    }
+};
@@ -0,0 +1,168 @@
+/*
+ * ConfigAllocator.hpp
+ *  Where MyConfigDb keeps its memory: the index (the sorted block of MyConfigDb::settings, with the short names and
+ *  values inline) and the values (the heap part of names and values longer than the SSO limit, 15 chars).
+ *
+ *      static ConfigPoolAllocator s_valuePool{64, 256, MALLOC_CAP_SPIRAM}; // 256 blocks of 64 bytes in PSRAM
+ *      static HeapCapsConfigAllocator s_index{MALLOC_CAP_INTERNAL};
+ *      ConfigAllocator::use(&s_index, &s_valuePool); // at boot, before any MyConfigDb is created
+ *
+ *  A MyConfigDb (and each of its strings) takes the allocator that is in use() when it is created, and keeps it
+ *  for its whole life, also through copies, moves and swaps. So the allocators must outlive every MyConfigDb
+ *  created while they were in use (make them static). Without use(), everything comes from the default heap.
+ *
+ *  - HeapCapsConfigAllocator: heap_caps_malloc() with fixed capabilities, i.e. MALLOC_CAP_SPIRAM.
+ *  - ConfigPoolAllocator: fixed-size blocks, allocated once. Allocating and freeing is a free list push/pop, so
+ *    insertions and erasures under the write lock neither take the time of the heap nor fragment it over weeks.
+ *    Larger requests (and any beyond the last block) fall back to heap_caps_malloc() with the same capabilities.
+ *  - ConfigArenaAllocator: a bump allocator over one block, for bulk settings that are loaded once (i.e. at boot)
+ *    and rarely change. Freed memory is only reused once everything in the arena was freed.
+ *  All of them can be used from several tasks at once (i.e. MyConfigDb copies destroyed outside the lock).
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+
+#include "HeapCapsAllocator.hpp"
+
+class ConfigAllocator
+{
+public:
+    enum class Role : uint8_t
+    {
+        Index,
+        Values,
+    };
+
+    virtual ~ConfigAllocator() = default;
+    // Never returns nullptr: aborts if out of memory, like operator new without exceptions
+    virtual void *allocate(std::size_t size) = 0;
+    virtual void deallocate(void *p, std::size_t size) = 0;
+
+    // Select the allocators of the MyConfigDbs created from now on. nullptr selects the default heap.
+    static void use(ConfigAllocator *index, ConfigAllocator *values);
+    // The allocator in use for `role`, never nullptr
+    static ConfigAllocator *current(Role role);
+    // The default heap (operator new). Never destroyed, so databases in static storage can still free into it.
+    static ConfigAllocator &heap();
+};
+
+// HeapCapsAllocator with the capabilities chosen at runtime
+class HeapCapsConfigAllocator : public ConfigAllocator
+{
+public:
+    explicit HeapCapsConfigAllocator(uint32_t caps) : m_caps{caps} {}
+    void *allocate(std::size_t size) override { return heapCapsAllocate(size, m_caps); }
+    void deallocate(void *p, std::size_t) override { heap_caps_free(p); }
+
+private:
+    const uint32_t m_caps;
+};
+
+class ConfigPoolAllocator : public ConfigAllocator
+{
+public:
+    // blockCount blocks of blockSize bytes (rounded up to the alignment of max_align_t), in one heap_caps_malloc()
+    ConfigPoolAllocator(std::size_t blockSize, std::size_t blockCount, uint32_t caps = MALLOC_CAP_DEFAULT);
+    ~ConfigPoolAllocator() override; // only when nothing allocated from it is left
+
+    ConfigPoolAllocator(const ConfigPoolAllocator &) = delete;
+    ConfigPoolAllocator &operator=(const ConfigPoolAllocator &) = delete;
+
+    void *allocate(std::size_t size) override;
+    void deallocate(void *p, std::size_t size) override;
+
+    std::size_t blockSize() const { return m_blockSize; }
+    std::size_t blocksUsed() const;
+    // number of allocations that did not fit in a block, or found the pool empty
+    uint32_t fallbacks() const { return m_fallbacks.load(std::memory_order_relaxed); }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    bool owns(const void *p) const { return p >= m_begin && p < m_end; }
+
+    const std::size_t m_blockSize;
+    const std::size_t m_blockCount;
+    const uint32_t m_caps;
+    uint8_t *m_begin{nullptr};
+    uint8_t *m_end{nullptr};
+    FreeBlock *m_free{nullptr};
+    std::size_t m_freeCount{0};
+    std::atomic<uint32_t> m_fallbacks{0};
+    mutable portMUX_TYPE m_mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+class ConfigArenaAllocator : public ConfigAllocator
+{
+public:
+    ConfigArenaAllocator(std::size_t size, uint32_t caps = MALLOC_CAP_DEFAULT);
+    ~ConfigArenaAllocator() override; // only when nothing allocated from it is left
+
+    ConfigArenaAllocator(const ConfigArenaAllocator &) = delete;
+    ConfigArenaAllocator &operator=(const ConfigArenaAllocator &) = delete;
+
+    void *allocate(std::size_t size) override;
+    void deallocate(void *p, std::size_t size) override;
+
+    std::size_t used() const;     // bytes handed out since the arena was last empty, freed or not
+    uint32_t fallbacks() const { return m_fallbacks.load(std::memory_order_relaxed); }
+
+private:
+    bool owns(const void *p) const { return p >= m_begin && p < m_end; }
+
+    const uint32_t m_caps;
+    uint8_t *m_begin{nullptr};
+    uint8_t *m_end{nullptr};
+    uint8_t *m_next{nullptr};
+    std::size_t m_live{0}; // allocations from the arena not freed yet
+    std::atomic<uint32_t> m_fallbacks{0};
+    mutable portMUX_TYPE m_mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Standard allocator on top of a ConfigAllocator, taken from ConfigAllocator::current(role) when it is created.
+// Stateful, and propagated with the containers on copy, move and swap.
+template <class T, ConfigAllocator::Role role>
+struct ConfigAllocatorRef
+{
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <class U>
+    struct rebind
+    {
+        using other = ConfigAllocatorRef<U, role>;
+    };
+
+    ConfigAllocatorRef() noexcept : allocator{ConfigAllocator::current(role)} {}
+    template <class U>
+    ConfigAllocatorRef(const ConfigAllocatorRef<U, role> &other) noexcept : allocator{other.allocator}
+    {
+    }
+
+    T *allocate(std::size_t n) { return static_cast<T *>(allocator->allocate(n * sizeof(T))); }
+    void deallocate(T *p, std::size_t n) noexcept { allocator->deallocate(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const ConfigAllocatorRef<U, role> &other) const noexcept { return allocator == other.allocator; }
+    template <class U>
+    bool operator!=(const ConfigAllocatorRef<U, role> &other) const noexcept { return allocator != other.allocator; }
+
+    ConfigAllocator *allocator;
+};
+
+// The string type of the values of MyConfigDb::settings
+using ConfigString = std::basic_string<char, std::char_traits<char>, ConfigAllocatorRef<char, ConfigAllocator::Role::Values>>;
@@ -0,0 +1,85 @@
+/*
+ * ConfigBlob.hpp
+ *  Compact, versioned binary form of MyConfigDb settings, to ship them between boards / to the cloud
+ *  or keep them in a flash partition, instead of JSON:
+ *
+ *      std::vector<uint8_t> blob;
+ *      if (auto db = dbMan.getReadAccess()) db->serialize(blob); // or snapshot->serialize(blob)
+ *
+ *      ConfigBlobView view{data, size};                          // i.e. esp_partition_mmap()ed, nothing is copied
+ *      if (auto db = dbMan.getWriteAccess(); db && view.valid()) db->load(view);
+ *
+ *  Layout (little-endian):
+ *      header      magic "cDbB", u16 version, u16 flags, u32 entry count, u32 total size,
+ *                  u32 checksum (settingHash() of everything after the header)
+ *      dictionary  only with flags & ConfigBlob::hasDictionary: u32 count, u32 offset of the entries,
+ *                  count x u32 offset of a string, the strings. Offsets are from the start of the blob.
+ *      entries     per entry: string name, then the value: varint n, a dictionary index (n >> 1) if n & 1,
+ *                  else n >> 1 bytes inline
+ *      index       only with flags & ConfigBlob::hasIndex: per entry u32 hash, u32 offset of the entry.
+ *                  Makes find() a binary search, for blobs that are looked up in place (MyConfigDb::setDefaults()).
+ *  A string is a varint (LEB128) length followed by its bytes. Entries are in MyConfigDb::settings order.
+ *  Values that repeat (true/false, enum names, ...) go into the dictionary when it makes the blob smaller.
+ *
+ *  ConfigBlobView checks the whole blob once (bounds, checksum, version) and then hands out string_views into
+ *  it, without allocating. The bytes only need byte access, no alignment, and must outlive the view.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "SettingKey.hpp"
+
+namespace ConfigBlob
+{
+    constexpr uint32_t magic = 0x42624463; // "cDbB"
+    constexpr uint16_t version = 1;        // blobs of any other version are rejected
+    constexpr uint16_t hasDictionary = 1U << 0;
+    constexpr uint16_t hasIndex = 1U << 1;
+    constexpr std::size_t headerSize = 20;
+} // namespace ConfigBlob
+
+class ConfigBlobView
+{
+public:
+    ConfigBlobView() : m_data{nullptr} {} // not valid(), an empty blob
+    ConfigBlobView(const void *data, std::size_t size);
+
+    // Whether the data is a complete blob of our version. All other functions see an empty blob if not.
+    bool valid() const { return m_entries != nullptr; }
+    uint32_t count() const { return m_count; }
+    // size of the blob in bytes (the size passed in may be larger, i.e. a whole partition)
+    std::size_t size() const { return valid() ? m_size : 0; }
+
+    // Calls fn(std::string_view name, std::string_view value) for every entry, in settings order.
+    template <class F>
+    void forEach(F &&fn) const
+    {
+        const uint8_t *p = m_entries;
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            std::string_view name, value;
+            p = readEntry(p, name, value);
+            fn(name, value);
+        }
+    }
+
+    // Binary search with an index, else linear (then, for many lookups, load() the blob into a MyConfigDb).
+    std::optional<std::string_view> find(SettingKey key) const;
+
+private:
+    // Entries were checked by the constructor, so these don't check bounds again
+    const uint8_t *readEntry(const uint8_t *p, std::string_view &name, std::string_view &value) const;
+    std::string_view dictionaryString(uint32_t index) const;
+
+    const uint8_t *m_data;
+    const uint8_t *m_entries{nullptr};
+    const uint8_t *m_index{nullptr};
+    const uint8_t *m_dictionary{nullptr}; // the offset table
+    uint32_t m_dictionaryCount{0};
+    uint32_t m_count{0};
+    uint32_t m_size{0};
+};
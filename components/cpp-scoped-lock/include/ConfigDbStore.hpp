@@ -0,0 +1,115 @@
+/*
+ * ConfigDbStore.hpp
+ *  NVS persistence of a MyConfigDbManager that never does flash I/O while holding its lock:
+ *
+ *      static ConfigDbStore s_store{dbMan, "config"};
+ *      s_store.loadAll(); // one bulk read at boot, or skip it and let get() load each key on its first miss
+ *      s_store.start();   // write-behind task
+ *
+ *  - loadAll() reads the whole NVS namespace into a local list first, then inserts it under one WriteAccess.
+ *  - get(key) answers from RAM. On a miss of a key that was not looked up yet, it reads that key from NVS
+ *    (no access held) and inserts it. Loaded values bypass MyConfigDb::set(), so they are not written back.
+ *  - The write-behind task subscribes to the manager. After a write it waits coalesceMs for more writes, copies
+ *    what changed since the last flush (MyConfigDb::forEachChangedSince()) under a ReadAccess, and writes it
+ *    to NVS with one nvs_commit() after releasing the access. A key set many times in that window is written once.
+ *    Then it drops the change records it flushed (MyConfigDb::forgetChangesUpTo()), so they don't grow with every
+ *    key ever changed. Other readers of forEachChangedSince() that fall behind a flush get false and re-read all.
+ *    If someone else forgot the records past the last flush, the next flush rewrites all settings instead.
+ *  - Erase keys that might only be in flash (not loaded yet) with erase(), MyConfigDb::erase() can't know them.
+ *
+ *  NVS mirrors MyConfigDb::settings, the overlay over the defaults (MyConfigDb::setDefaults()): a key set back to
+ *  its default value is erased from flash.
+ *
+ *  NVS keys are limited to 15 characters, so every setting is stored as a blob "name\0value" under the hex
+ *  representation of its hash. Names with the same hash take the keys "<hash>.1" ... "<hash>.7" after it: every read,
+ *  write and erase compares the stored name, so they never overwrite each other (an eighth one fails to flush).
+ *
+ *  Don't call the store while holding an access of its manager: flushes take the store's I/O mutex first,
+ *  then a ReadAccess.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "MyConfigDb.hpp"
+
+class ConfigDbStore
+{
+public:
+#ifdef CONFIG_SCOPED_LOCK_NVS_COALESCE_MS
+    static constexpr uint32_t defaultCoalesceMs = CONFIG_SCOPED_LOCK_NVS_COALESCE_MS;
+#else
+    static constexpr uint32_t defaultCoalesceMs = 200;
+#endif
+
+    // nvsNamespace: at most 15 characters, see nvs_open(). nvs_flash_init() must have been called.
+    // Changes made to `db` before the store is constructed are not persisted.
+    ConfigDbStore(MyConfigDbManager &db, const char *nvsNamespace);
+    ~ConfigDbStore(); // stop()s the task, which flushes what is left
+
+    ConfigDbStore(const ConfigDbStore &) = delete;
+    ConfigDbStore &operator=(const ConfigDbStore &) = delete;
+
+    // Read every setting of the namespace, and insert those not in RAM yet. Afterwards get() never reads NVS.
+    // Returns false if NVS could not be read (an empty or missing namespace is fine).
+    bool loadAll();
+
+    // The value of `key`, from RAM, or on the first miss from NVS. A copy, since no access is held on return.
+    std::optional<std::string> get(SettingKey key);
+
+    // Erase `key` from RAM and (with the next flush) from NVS, also if it was never loaded.
+    void erase(SettingKey key);
+
+    // Start the write-behind task. Does nothing if it is already running.
+    bool start(UBaseType_t priority = tskIDLE_PRIORITY + 1, uint32_t coalesceMs = defaultCoalesceMs);
+    // Stop the task and flush() what is pending.
+    void stop();
+
+    // Write everything changed since the last flush to NVS now. Used by the task, or before a restart.
+    // Returns false (and keeps the changes for the next try) if NVS could not be written.
+    bool flush();
+
+    uint32_t flushes() const { return m_flushes.load(std::memory_order_relaxed); }         // commits to NVS
+    uint32_t keysWritten() const { return m_keysWritten.load(std::memory_order_relaxed); } // set or erased in NVS
+
+private:
+    struct Change
+    {
+        SettingName name;
+        std::optional<std::string> value; // nullopt: erase
+    };
+
+    static void taskFunc(void *arg);
+    bool readKey(SettingKey key, std::string &value); // from NVS, without any lock of the manager
+    bool writeBatch(const std::vector<Change> &batch);
+    bool readAll(std::vector<std::pair<std::string, std::string>> &loaded); // every (name, value) of the namespace
+    bool addForgottenErases(std::vector<Change> &batch);
+
+    MyConfigDbManager &m_db;
+    const char *m_namespace;
+
+    // Serializes flushes and NVS loads, and guards the members below. Always taken before an access of m_db.
+    SemaphoreHandle_t m_ioMutex;
+    uint32_t m_flushedRevision{0};
+    std::vector<SettingName> m_pendingErases;               // erase() of keys that were not in RAM
+    FlatMap<SettingName, bool, SettingName::Less> m_probed; // keys get() already looked up in NVS
+    std::atomic<bool> m_allLoaded{false}; // also read without m_ioMutex
+
+    std::atomic<TaskHandle_t> m_task{nullptr};
+    SemaphoreHandle_t m_stopped{nullptr};
+    uint32_t m_coalesceMs{defaultCoalesceMs};
+    std::atomic<uint32_t> m_flushes{0};
+    std::atomic<uint32_t> m_keysWritten{0};
+};
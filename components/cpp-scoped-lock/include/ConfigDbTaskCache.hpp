@@ -0,0 +1,83 @@
+/*
+ * ConfigDbTaskCache.hpp
+ *  Per task cache of typed MyConfigDb values, for tasks that read the same settings very often:
+ *
+ *      static ConfigDbTaskCache s_cache{MyConfigDbManager::getInstance()};
+ *
+ *      void controlLoop(void *) // every 1ms
+ *      {
+ *          constexpr SettingKey gainKey{"sensor.gain"};
+ *          float gain = s_cache.getFloat(gainKey).value_or(1.0f); // no lock, unless the database changed
+ *      }
+ *
+ *  Each task has its own copy of the values it read, kept in one of its FreeRTOS thread local storage pointers
+ *  (CONFIG_SCOPED_LOCK_TASK_CACHE_TLS_INDEX), so a hit takes only one atomic load: a compare of the manager's
+ *  generation() with the one the values were read at. After any WriteAccess the generation differs, the task's
+ *  first read drops all of its values and takes a ReadAccess again, and the values refill one by one.
+ *
+ *  The values of a task are freed when the task is deleted (or with releaseTask()). Meant for long-lived
+ *  (i.e. static) caches: a task keeps the values of a destroyed cache until then.
+ *
+ *  Only built with CONFIG_SCOPED_LOCK_TASK_CACHE, which needs CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS > 1.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#if !CONFIG_SCOPED_LOCK_TASK_CACHE
+#error "ConfigDbTaskCache needs CONFIG_SCOPED_LOCK_TASK_CACHE (and CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS > 1)"
+#endif
+
+#include "MyConfigDb.hpp"
+#include "SettingKey.hpp"
+#include "TypedSettings.hpp"
+
+#ifdef CONFIG_SCOPED_LOCK_TASK_CACHE_TLS_INDEX
+#define SCOPED_LOCK_TASK_CACHE_TLS_INDEX CONFIG_SCOPED_LOCK_TASK_CACHE_TLS_INDEX
+#else
+#define SCOPED_LOCK_TASK_CACHE_TLS_INDEX 1
+#endif
+
+class ConfigDbTaskCache
+{
+public:
+    static constexpr int tlsIndex = SCOPED_LOCK_TASK_CACHE_TLS_INDEX;
+
+    explicit ConfigDbTaskCache(MyConfigDbManager &dbMan);
+
+    ConfigDbTaskCache(const ConfigDbTaskCache &) = delete;
+    ConfigDbTaskCache &operator=(const ConfigDbTaskCache &) = delete;
+
+    // Like MyConfigDb::getInt() and friends. A missing or invalid value is cached too (as nullopt).
+    // nullopt without caching if the ReadAccess times out.
+    std::optional<int32_t> getInt(SettingKey key)
+    {
+        SettingValue v;
+        return lookup(key, SettingType::Int, v) ? std::optional<int32_t>(v.i) : std::nullopt;
+    }
+    std::optional<float> getFloat(SettingKey key)
+    {
+        SettingValue v;
+        return lookup(key, SettingType::Float, v) ? std::optional<float>(v.f) : std::nullopt;
+    }
+    std::optional<bool> getBool(SettingKey key)
+    {
+        SettingValue v;
+        return lookup(key, SettingType::Bool, v) ? std::optional<bool>(v.b) : std::nullopt;
+    }
+
+    // Free the values the calling task cached, of all ConfigDbTaskCaches. Done automatically when a task is deleted.
+    static void releaseTask();
+
+private:
+    // Returns whether the key has a valid value of `type`, from the task's values or the database
+    bool lookup(SettingKey key, SettingType type, SettingValue &value);
+
+    MyConfigDbManager &m_dbMan;
+    const uint32_t m_id; // tells the caches apart in a task's values, never reused (addresses could be)
+};
@@ -0,0 +1,306 @@
+/*
+ * FairSharedMutex.hpp
+ *  Reader/writer mutex with a selectable fairness policy, as mutex policy for LockableObject:
+ *
+ *      using MyConfigDbManager = LockableObject<MyConfigDb, PhaseFairSharedMutex>;
+ *
+ *  The lock state is guarded by a spinlock (held for a few instructions only). Tasks that can't enter
+ *  immediately queue in FIFO order, each blocking on its own semaphore: readers in one queue, writers
+ *  in another. On release, the policy decides who is granted the lock next, and the lock is handed
+ *  over directly to the waiter(s), so nobody can barge in between.
+ *
+ *  Worst-case waits, with Tr = longest read section, Tw = longest write section,
+ *  Nw = number of writers queued ahead:
+ *
+ *  - ReaderPreferring: readers enter whenever no writer is active.
+ *      reader: Tw.
+ *      writer: unbounded, a steady stream of overlapping readers starves writers.
+ *  - WriterPreferring: readers don't enter while a writer is queued.
+ *      reader: unbounded, a steady stream of writers starves readers.
+ *      writer: Tr + Nw * Tw.
+ *  - PhaseFair: read and write phases alternate. Readers don't enter while a writer is queued, but when a
+ *    writer releases, all queued readers are let in before the next writer.
+ *      reader: Tr + Tw (the rest of the read phase it arrived in, as a writer is queued, then that write phase;
+ *      arriving in a write phase, just Tw).
+ *      writer: Tr + Nw * (Tw + Tr).
+ *    Both are bounded, so this is the one to pick when writes need a predictable latency while readers keep running.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "FreeRtosSharedMutex.hpp"
+
+enum class LockFairness
+{
+    ReaderPreferring,
+    WriterPreferring,
+    PhaseFair,
+};
+
+template <LockFairness fairness>
+class FairSharedMutex
+{
+public:
+    FairSharedMutex()
+    {
+        portMUX_INITIALIZE(&m_spinlock);
+    }
+    FairSharedMutex(const FairSharedMutex &) = delete;
+    FairSharedMutex &operator=(const FairSharedMutex &) = delete;
+
+    //-- Exclusive (writer) side. Same interface as std::shared_timed_mutex, so std::unique_lock works.
+
+    void lock() { acquire(true, portMAX_DELAY); }
+    bool try_lock() { return acquire(true, 0); }
+
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return acquire(true, FreeRtosSharedMutex::toTicks(timeout_duration));
+    }
+
+    void unlock()
+    {
+        portENTER_CRITICAL(&m_spinlock);
+        m_activeWriter = false;
+        Waiter *granted = dispatch(true);
+        portEXIT_CRITICAL(&m_spinlock);
+        wake(granted);
+    }
+
+    //-- Shared (reader) side. Same interface as std::shared_timed_mutex, so std::shared_lock works.
+
+    void lock_shared() { acquire(false, portMAX_DELAY); }
+    bool try_lock_shared() { return acquire(false, 0); }
+
+    template <class Rep, class Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return acquire(false, FreeRtosSharedMutex::toTicks(timeout_duration));
+    }
+
+    void unlock_shared()
+    {
+        Waiter *granted = nullptr;
+        portENTER_CRITICAL(&m_spinlock);
+        if (--m_activeReaders == 0)
+        {
+            granted = dispatch(false);
+        }
+        portEXIT_CRITICAL(&m_spinlock);
+        wake(granted);
+    }
+
+private:
+    // A queued task. Lives on the waiting task's stack.
+    struct Waiter
+    {
+        Waiter *next{nullptr};
+        bool granted{false};
+        StaticSemaphore_t semBuffer{};
+        SemaphoreHandle_t sem{nullptr};
+    };
+
+    // FIFO of waiters
+    struct Queue
+    {
+        Waiter *head{nullptr};
+        Waiter *tail{nullptr};
+
+        bool empty() const { return head == nullptr; }
+
+        void push(Waiter *w)
+        {
+            w->next = nullptr;
+            if (tail)
+            {
+                tail->next = w;
+            }
+            else
+            {
+                head = w;
+            }
+            tail = w;
+        }
+
+        Waiter *pop()
+        {
+            Waiter *w = head;
+            head = w->next;
+            if (!head)
+            {
+                tail = nullptr;
+            }
+            w->next = nullptr;
+            return w;
+        }
+
+        // detach the whole queue as a chain
+        Waiter *takeAll()
+        {
+            Waiter *w = head;
+            head = tail = nullptr;
+            return w;
+        }
+
+        void remove(Waiter *w)
+        {
+            Waiter *prev = nullptr;
+            for (Waiter *it = head; it; prev = it, it = it->next)
+            {
+                if (it == w)
+                {
+                    (prev ? prev->next : head) = w->next;
+                    if (tail == w)
+                    {
+                        tail = prev;
+                    }
+                    w->next = nullptr;
+                    return;
+                }
+            }
+        }
+    };
+
+    bool canEnter(bool writer) const
+    {
+        if (m_activeWriter)
+        {
+            return false;
+        }
+        if (writer)
+        {
+            return m_activeReaders == 0 && m_writers.empty() && m_readers.empty();
+        }
+        return (fairness == LockFairness::ReaderPreferring) || m_writers.empty();
+    }
+
+    // Decide who gets the lock next. Called with the spinlock held. Marks the granted waiters,
+    // updates the lock state on their behalf, and returns them as a chain to be woken after the spinlock is released.
+    Waiter *dispatch(bool afterWrite)
+    {
+        if (m_activeWriter)
+        {
+            return nullptr;
+        }
+        const bool readersFirst = (fairness == LockFairness::ReaderPreferring) ||
+                                  (fairness == LockFairness::PhaseFair && afterWrite) ||
+                                  m_writers.empty();
+        if (readersFirst && !m_readers.empty())
+        {
+            Waiter *chain = m_readers.takeAll();
+            for (Waiter *w = chain; w; w = w->next)
+            {
+                w->granted = true;
+                m_activeReaders++;
+            }
+            return chain;
+        }
+        if (m_activeReaders == 0 && !m_writers.empty())
+        {
+            Waiter *w = m_writers.pop();
+            w->granted = true;
+            m_activeWriter = true;
+            return w;
+        }
+        return nullptr;
+    }
+
+    static void wake(Waiter *chain)
+    {
+        while (chain)
+        {
+            // read everything we need first: the waiter may return (and its node go away) as soon as it is given
+            Waiter *next = chain->next;
+            xSemaphoreGive(chain->sem);
+            chain = next;
+        }
+    }
+
+    // Enter if the policy allows it right now. Called with the spinlock held.
+    bool tryEnter(bool writer)
+    {
+        if (!canEnter(writer))
+        {
+            return false;
+        }
+        if (writer)
+        {
+            m_activeWriter = true;
+        }
+        else
+        {
+            m_activeReaders++;
+        }
+        return true;
+    }
+
+    bool acquire(bool writer, TickType_t ticks)
+    {
+        portENTER_CRITICAL(&m_spinlock);
+        bool acquired = tryEnter(writer);
+        portEXIT_CRITICAL(&m_spinlock);
+        if (acquired || ticks == 0)
+        {
+            return acquired;
+        }
+
+        // Slow path. The semaphore is created outside of the spinlock (no FreeRTOS calls in a critical section),
+        // so check again before queueing.
+        Waiter self{};
+        self.sem = xSemaphoreCreateBinaryStatic(&self.semBuffer);
+        portENTER_CRITICAL(&m_spinlock);
+        acquired = tryEnter(writer);
+        if (!acquired)
+        {
+            (writer ? m_writers : m_readers).push(&self);
+        }
+        portEXIT_CRITICAL(&m_spinlock);
+        if (acquired)
+        {
+            vSemaphoreDelete(self.sem);
+            return true;
+        }
+
+        acquired = (pdTRUE == xSemaphoreTake(self.sem, ticks));
+        if (!acquired)
+        {
+            Waiter *granted = nullptr;
+            portENTER_CRITICAL(&m_spinlock);
+            if (self.granted)
+            {
+                acquired = true; // granted just as we timed out, the give is on its way
+            }
+            else
+            {
+                (writer ? m_writers : m_readers).remove(&self);
+                // a writer leaving the queue may unblock readers that were held back for it
+                granted = dispatch(false);
+            }
+            portEXIT_CRITICAL(&m_spinlock);
+            wake(granted);
+            if (acquired)
+            {
+                xSemaphoreTake(self.sem, portMAX_DELAY);
+            }
+        }
+        vSemaphoreDelete(self.sem);
+        return acquired;
+    }
+
+    portMUX_TYPE m_spinlock;
+    int m_activeReaders{0};
+    bool m_activeWriter{false};
+    Queue m_readers{};
+    Queue m_writers{};
+};
+
+using ReaderPreferringSharedMutex = FairSharedMutex<LockFairness::ReaderPreferring>;
+using WriterPreferringSharedMutex = FairSharedMutex<LockFairness::WriterPreferring>;
+using PhaseFairSharedMutex = FairSharedMutex<LockFairness::PhaseFair>;
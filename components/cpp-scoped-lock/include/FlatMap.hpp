@@ -0,0 +1,262 @@
+/*
+ * FlatMap.hpp
+ *  Sorted-vector associative container with a std::map-like API.
+ *
+ *  All entries live in one contiguous allocation, so a lookup is a binary search over adjacent memory
+ *  instead of a pointer chase through tree nodes, and there is no per-key node allocation.
+ *  With std::string keys/values, short strings (up to the SSO limit, 15 chars in libstdc++) are stored
+ *  inline in that same block, so the common small setting costs no heap allocation of its own.
+ *  Pass an allocator (i.e. HeapCapsAllocator) to place the block in a chosen memory region, like PSRAM.
+ *
+ *  Differences to std::map:
+ *   - insert/erase are O(n) and invalidate iterators and references. Fine for settings that change rarely.
+ *   - value_type is std::pair<Key, T> (the key is not const), don't modify keys through iterators.
+ *   - at() asserts instead of throwing (exceptions are disabled in our builds).
+ *   - a transparent Compare may name a probe_type: heterogeneous lookup keys convertible to it are
+ *     converted once per lookup instead of once per comparison (see SettingName::Less).
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <class Key, class T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<Key, T>>>
+class FlatMap
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using container_type = std::vector<value_type, Allocator>;
+    using size_type = typename container_type::size_type;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+    FlatMap() = default;
+    explicit FlatMap(const Allocator &alloc) : m_entries(alloc) {}
+    FlatMap(std::initializer_list<value_type> init, const Allocator &alloc = Allocator()) : m_entries(alloc)
+    {
+        m_entries.reserve(init.size());
+        for (const auto &v : init)
+        {
+            insert(v);
+        }
+    }
+
+    //-- iterators (in key order)
+    iterator begin() noexcept { return m_entries.begin(); }
+    iterator end() noexcept { return m_entries.end(); }
+    const_iterator begin() const noexcept { return m_entries.begin(); }
+    const_iterator end() const noexcept { return m_entries.end(); }
+    const_iterator cbegin() const noexcept { return m_entries.cbegin(); }
+    const_iterator cend() const noexcept { return m_entries.cend(); }
+
+    //-- capacity
+    bool empty() const noexcept { return m_entries.empty(); }
+    size_type size() const noexcept { return m_entries.size(); }
+    size_type capacity() const noexcept { return m_entries.capacity(); }
+    void reserve(size_type n) { m_entries.reserve(n); }
+    void shrink_to_fit() { m_entries.shrink_to_fit(); }
+    // removes all entries but keeps the allocated block for reuse
+    void clear() noexcept { m_entries.clear(); }
+
+    //-- lookup. The templated overloads take any key type the comparator accepts (if Compare::is_transparent).
+    iterator lower_bound(const Key &key) { return lowerBound(*this, key); }
+    const_iterator lower_bound(const Key &key) const { return lowerBound(*this, key); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator lower_bound(const K &key) { return lowerBound(*this, key); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K &key) const { return lowerBound(*this, key); }
+
+    iterator find(const Key &key) { return findImpl(*this, key); }
+    const_iterator find(const Key &key) const { return findImpl(*this, key); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K &key) { return findImpl(*this, key); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K &key) const { return findImpl(*this, key); }
+
+    size_type count(const Key &key) const { return find(key) != end() ? 1 : 0; }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K &key) const { return find(key) != end() ? 1 : 0; }
+    bool contains(const Key &key) const { return find(key) != end(); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    bool contains(const K &key) const { return find(key) != end(); }
+
+    T &at(const Key &key) { return atImpl(*this, key); }
+    const T &at(const Key &key) const { return atImpl(*this, key); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    T &at(const K &key) { return atImpl(*this, key); }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const T &at(const K &key) const { return atImpl(*this, key); }
+
+    T &operator[](const Key &key) { return try_emplace(key).first->second; }
+    T &operator[](Key &&key) { return try_emplace(std::move(key)).first->second; }
+
+    //-- modifiers
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        auto it = lower_bound(key);
+        if (it != end() && !m_compare(key, it->first))
+        {
+            return {it, false};
+        }
+        it = m_entries.emplace(it, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {it, true};
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args)
+    {
+        auto it = lower_bound(key);
+        if (it != end() && !m_compare(key, it->first))
+        {
+            return {it, false};
+        }
+        it = m_entries.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {it, true};
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args &&...args)
+    {
+        value_type v(std::forward<Args>(args)...);
+        return try_emplace(std::move(v.first), std::move(v.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type &v) { return try_emplace(v.first, v.second); }
+    std::pair<iterator, bool> insert(value_type &&v) { return try_emplace(std::move(v.first), std::move(v.second)); }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj)
+    {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if (!result.second)
+        {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    iterator erase(const_iterator pos) { return m_entries.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) { return m_entries.erase(first, last); }
+    size_type erase(const Key &key)
+    {
+        auto it = find(key);
+        if (it == end())
+        {
+            return 0;
+        }
+        m_entries.erase(it);
+        return 1;
+    }
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type erase(const K &key)
+    {
+        auto it = find(key);
+        if (it == end())
+        {
+            return 0;
+        }
+        m_entries.erase(it);
+        return 1;
+    }
+
+    void swap(FlatMap &other) noexcept
+    {
+        using std::swap;
+        swap(m_entries, other.m_entries);
+        swap(m_compare, other.m_compare);
+    }
+
+    key_compare key_comp() const { return m_compare; }
+    allocator_type get_allocator() const { return m_entries.get_allocator(); }
+
+    bool operator==(const FlatMap &other) const { return m_entries == other.m_entries; }
+    bool operator!=(const FlatMap &other) const { return m_entries != other.m_entries; }
+
+private:
+    template <class C, class = void>
+    struct probeTypeOf
+    {
+        using type = void;
+    };
+    template <class C>
+    struct probeTypeOf<C, std::void_t<typename C::probe_type>>
+    {
+        using type = typename C::probe_type;
+    };
+    using probe_type = typename probeTypeOf<Compare>::type;
+
+    // Convert a lookup key to Compare::probe_type (if any) once, so it isn't converted again on every comparison.
+    template <class K>
+    static decltype(auto) makeProbe(const K &key)
+    {
+        if constexpr (!std::is_void<probe_type>::value && !std::is_same<K, Key>::value && !std::is_same<K, probe_type>::value &&
+                      std::is_convertible<const K &, probe_type>::value)
+        {
+            return probe_type(key);
+        }
+        else
+        {
+            return (key);
+        }
+    }
+
+    // shared implementations for the const and non-const overloads
+    template <class Self, class K>
+    static auto lowerBound(Self &self, const K &key)
+    {
+        const auto &probe = makeProbe(key);
+        using P = std::decay_t<decltype(probe)>;
+        return std::lower_bound(self.m_entries.begin(), self.m_entries.end(), probe,
+                                [&self](const value_type &entry, const P &k) { return self.m_compare(entry.first, k); });
+    }
+
+    template <class Self, class K>
+    static auto findImpl(Self &self, const K &key)
+    {
+        const auto &probe = makeProbe(key);
+        auto it = lowerBound(self, probe);
+        return (it != self.m_entries.end() && !self.m_compare(probe, it->first)) ? it : self.m_entries.end();
+    }
+
+    template <class Self, class K>
+    static auto &atImpl(Self &self, const K &key)
+    {
+        auto it = findImpl(self, key);
+        assert(it != self.m_entries.end()); // key must exist
+        if (it == self.m_entries.end())
+        {
+            abort();
+        }
+        return it->second;
+    }
+
+    container_type m_entries{};
+    Compare m_compare{};
+};
+
+template <class Key, class T, class Compare, class Allocator>
+void swap(FlatMap<Key, T, Compare, Allocator> &a, FlatMap<Key, T, Compare, Allocator> &b) noexcept
+{
+    a.swap(b);
+}
+
+// Like C++20 std::erase_if() of the standard maps: one pass, the order and the capacity are kept
+template <class Key, class T, class Compare, class Allocator, class Predicate>
+typename FlatMap<Key, T, Compare, Allocator>::size_type erase_if(FlatMap<Key, T, Compare, Allocator> &map, Predicate pred)
+{
+    auto kept = std::remove_if(map.begin(), map.end(), pred);
+    const auto erased = static_cast<typename FlatMap<Key, T, Compare, Allocator>::size_type>(map.end() - kept);
+    map.erase(kept, map.end());
+    return erased;
+}
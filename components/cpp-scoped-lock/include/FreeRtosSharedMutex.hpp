@@ -0,0 +1,158 @@
+/*
+ * FreeRtosSharedMutex.hpp
+ *  Reader/writer mutex built directly on FreeRTOS primitives.
+ *  Drop-in replacement for std::shared_timed_mutex as the mutex policy of LockableObject:
+ *
+ *      using MyFastDbManager = LockableObject<MyConfigDb, FreeRtosSharedMutex>;
+ *
+ *  Readers take a lock-free fast path (one compare-and-swap on an atomic state word) as long as no
+ *  writer holds or waits for the lock. Writers serialize on a FreeRTOS mutex, so a blocked reader or
+ *  writer lends its priority to the writer that holds the lock (priority inheritance).
+ *  Readers never block each other, so a read timeout only happens when a writer really holds the lock.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+class FreeRtosSharedMutex
+{
+public:
+    FreeRtosSharedMutex()
+        : m_writerMutex{xSemaphoreCreateMutexStatic(&m_writerMutexBuffer)},
+          m_readersDone{xSemaphoreCreateBinaryStatic(&m_readersDoneBuffer)}
+    {
+    }
+
+    ~FreeRtosSharedMutex()
+    {
+        vSemaphoreDelete(m_readersDone);
+        vSemaphoreDelete(m_writerMutex);
+    }
+
+    FreeRtosSharedMutex(const FreeRtosSharedMutex &) = delete;
+    FreeRtosSharedMutex &operator=(const FreeRtosSharedMutex &) = delete;
+
+    // Convert a std::chrono duration to FreeRTOS ticks, rounding up and saturating to portMAX_DELAY.
+    template <class Rep, class Period>
+    static TickType_t toTicks(const std::chrono::duration<Rep, Period> &d)
+    {
+        using ticks = std::chrono::duration<int64_t, std::ratio<1, configTICK_RATE_HZ>>;
+        if (d <= d.zero())
+        {
+            return 0;
+        }
+        // compare in milliseconds first, so that huge durations (i.e. milliseconds::max()) don't overflow
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(d).count() >= static_cast<int64_t>(portMAX_DELAY))
+        {
+            return portMAX_DELAY;
+        }
+        auto t = std::chrono::ceil<ticks>(d).count();
+        return t >= static_cast<int64_t>(portMAX_DELAY) ? portMAX_DELAY : static_cast<TickType_t>(t);
+    }
+
+    //-- Exclusive (writer) side. Same interface as std::shared_timed_mutex, so std::unique_lock works.
+
+    void lock() { try_lock_for_ticks(portMAX_DELAY); }
+    bool try_lock() { return try_lock_for_ticks(0); }
+
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return try_lock_for_ticks(toTicks(timeout_duration));
+    }
+
+    void unlock()
+    {
+        m_state.fetch_and(~writerBit, std::memory_order_release);
+        xSemaphoreGive(m_writerMutex);
+    }
+
+    //-- Shared (reader) side. Same interface as std::shared_timed_mutex, so std::shared_lock works.
+
+    void lock_shared() { try_lock_shared_for_ticks(portMAX_DELAY); }
+    bool try_lock_shared() { return try_lock_shared_for_ticks(0); }
+
+    template <class Rep, class Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return try_lock_shared_for_ticks(toTicks(timeout_duration));
+    }
+
+    void unlock_shared()
+    {
+        const uint32_t prev = m_state.fetch_sub(1, std::memory_order_release);
+        if ((prev & writerBit) && ((prev & readerMask) == 1))
+        {
+            // last reader out while a writer is waiting: wake the writer
+            xSemaphoreGive(m_readersDone);
+        }
+    }
+
+private:
+    static constexpr uint32_t writerBit = 1UL << 31;     // a writer holds (or is draining readers for) the lock
+    static constexpr uint32_t readerMask = writerBit - 1; // number of active readers
+
+    bool try_lock_for_ticks(TickType_t ticks)
+    {
+        const TickType_t start = xTaskGetTickCount();
+        if (pdTRUE != xSemaphoreTake(m_writerMutex, ticks))
+        {
+            return false;
+        }
+        // From now on no new reader can enter; wait until the active ones have left.
+        const uint32_t prev = m_state.fetch_or(writerBit, std::memory_order_acquire);
+        if ((prev & readerMask) == 0)
+        {
+            return true;
+        }
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        const TickType_t remaining = (ticks == portMAX_DELAY) ? portMAX_DELAY : (elapsed < ticks ? ticks - elapsed : 0);
+        if (pdTRUE == xSemaphoreTake(m_readersDone, remaining))
+        {
+            return true;
+        }
+        // Timed out. Withdraw, but if the last reader left in the meantime it has given (or is about to give)
+        // m_readersDone. Consume that token so that the next writer does not see a stale one.
+        const uint32_t now = m_state.fetch_and(~writerBit, std::memory_order_relaxed);
+        if ((now & readerMask) == 0)
+        {
+            xSemaphoreTake(m_readersDone, portMAX_DELAY);
+        }
+        xSemaphoreGive(m_writerMutex);
+        return false;
+    }
+
+    bool try_lock_shared_for_ticks(TickType_t ticks)
+    {
+        // Fast path: no writer, just bump the reader count.
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        while (!(state & writerBit))
+        {
+            if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        // Slow path: a writer is active. Queue up on the writer mutex (lending our priority to the writer).
+        // Once we hold it, no writer can be active, so the reader count can safely be bumped.
+        if (pdTRUE != xSemaphoreTake(m_writerMutex, ticks))
+        {
+            return false;
+        }
+        m_state.fetch_add(1, std::memory_order_acquire);
+        xSemaphoreGive(m_writerMutex);
+        return true;
+    }
+
+    std::atomic<uint32_t> m_state{0};
+    StaticSemaphore_t m_writerMutexBuffer{};
+    StaticSemaphore_t m_readersDoneBuffer{};
+    SemaphoreHandle_t m_writerMutex;
+    SemaphoreHandle_t m_readersDone;
+};
@@ -0,0 +1,59 @@
+/*
+ * HeapCapsAllocator.hpp
+ *  Standard allocator that allocates from ESP-IDF heap_caps_malloc() with fixed capabilities,
+ *  i.e. to place a container's storage in PSRAM:
+ *
+ *      FlatMap<std::string, std::string, std::less<>, HeapCapsAllocator<std::pair<std::string, std::string>, MALLOC_CAP_SPIRAM>>
+ *
+ *  HeapCapsConfigAllocator (ConfigAllocator.hpp) is the same with the capabilities chosen at runtime.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "esp_heap_caps.h"
+
+// heap_caps_malloc() that never returns nullptr
+inline void *heapCapsAllocate(std::size_t size, uint32_t caps)
+{
+    void *p = heap_caps_malloc(size, caps);
+    if (!p)
+    {
+        abort(); // out of memory in the requested region, same as operator new without exceptions
+    }
+    return p;
+}
+
+template <class T, uint32_t caps = MALLOC_CAP_DEFAULT>
+struct HeapCapsAllocator
+{
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = HeapCapsAllocator<U, caps>;
+    };
+
+    HeapCapsAllocator() noexcept = default;
+    template <class U>
+    HeapCapsAllocator(const HeapCapsAllocator<U, caps> &) noexcept {}
+
+    T *allocate(std::size_t n)
+    {
+        return static_cast<T *>(heapCapsAllocate(n * sizeof(T), caps));
+    }
+
+    void deallocate(T *p, std::size_t) noexcept
+    {
+        heap_caps_free(p);
+    }
+
+    template <class U>
+    bool operator==(const HeapCapsAllocator<U, caps> &) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const HeapCapsAllocator<U, caps> &) const noexcept { return false; }
+};
@@ -0,0 +1,161 @@
+/*
+ * LockStats.hpp
+ *  Per-instance contention statistics for LockableObject.
+ *  Compiled in with CONFIG_SCOPED_LOCK_STATS (menuconfig: Component config -> C++ scoped lock).
+ *
+ *      auto stats = MyConfigDbManager::getInstance().getStats();
+ *      logLockStats("cDb", "config db", stats);
+ *
+ *  For tracing, define SCOPED_LOCK_TRACE_ACQUIRE / SCOPED_LOCK_TRACE_RELEASE (i.e. project-wide with
+ *  idf_build_set_property(COMPILE_DEFINITIONS ...)) to forward every acquire/release to SystemView or
+ *  esp_app_trace, i.e:
+ *
+ *      -DSCOPED_LOCK_TRACE_ACQUIRE(obj,isWrite,acquired,waitUs)=SEGGER_SYSVIEW_PrintfHost("lock %p w%d ok%d %u",obj,isWrite,acquired,waitUs)
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef SCOPED_LOCK_TRACE_ACQUIRE
+#define SCOPED_LOCK_TRACE_ACQUIRE(obj, isWrite, acquired, waitUs)
+#endif
+#ifndef SCOPED_LOCK_TRACE_RELEASE
+#define SCOPED_LOCK_TRACE_RELEASE(obj, isWrite, holdUs)
+#endif
+
+// A consistent-enough copy of the statistics (each counter is read atomically, not the set as a whole).
+struct LockStatsSnapshot
+{
+    // wait time histogram: [0] < 10us, [1] < 100us, [2] < 1ms, [3] < 10ms, [4] < 100ms, [5] >= 100ms
+    static constexpr std::size_t histogramBuckets = 6;
+
+    struct Side
+    {
+        uint32_t attempts;
+        uint32_t acquired;
+        uint32_t timeouts;
+        uint32_t waitHistogram[histogramBuckets]; // successful and timed out acquisitions
+        uint32_t maxWaitUs;
+        uint32_t maxHoldUs;
+        uint64_t totalHoldUs;
+    };
+
+    bool enabled;        // false when built without CONFIG_SCOPED_LOCK_STATS, everything else is zero then
+    Side read;
+    Side write;
+    TaskHandle_t writer; // task currently holding the write lock, or nullptr
+};
+
+class LockStats
+{
+public:
+    void recordAcquire(bool write, bool acquired, int64_t waitUs)
+    {
+        Side &side = write ? m_write : m_read;
+        const uint32_t wait = waitUs < 0 ? 0 : (waitUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(waitUs));
+        side.attempts.fetch_add(1, std::memory_order_relaxed);
+        (acquired ? side.acquired : side.timeouts).fetch_add(1, std::memory_order_relaxed);
+        side.waitHistogram[bucket(wait)].fetch_add(1, std::memory_order_relaxed);
+        updateMax(side.maxWaitUs, wait);
+        if (write && acquired)
+        {
+            m_writer.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+        }
+    }
+
+    void recordRelease(bool write, int64_t holdUs)
+    {
+        Side &side = write ? m_write : m_read;
+        const uint32_t hold = holdUs < 0 ? 0 : (holdUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(holdUs));
+        side.totalHoldUs.fetch_add(hold, std::memory_order_relaxed);
+        updateMax(side.maxHoldUs, hold);
+        if (write)
+        {
+            m_writer.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    LockStatsSnapshot snapshot() const
+    {
+        LockStatsSnapshot s{};
+        s.enabled = true;
+        copy(m_read, s.read);
+        copy(m_write, s.write);
+        s.writer = m_writer.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void clear()
+    {
+        for (Side *side : {&m_read, &m_write})
+        {
+            side->attempts = 0;
+            side->acquired = 0;
+            side->timeouts = 0;
+            for (auto &b : side->waitHistogram)
+            {
+                b = 0;
+            }
+            side->maxWaitUs = 0;
+            side->maxHoldUs = 0;
+            side->totalHoldUs = 0;
+        }
+    }
+
+private:
+    struct Side
+    {
+        std::atomic<uint32_t> attempts{0};
+        std::atomic<uint32_t> acquired{0};
+        std::atomic<uint32_t> timeouts{0};
+        std::atomic<uint32_t> waitHistogram[LockStatsSnapshot::histogramBuckets]{};
+        std::atomic<uint32_t> maxWaitUs{0};
+        std::atomic<uint32_t> maxHoldUs{0};
+        std::atomic<uint64_t> totalHoldUs{0};
+    };
+
+    static std::size_t bucket(uint32_t us)
+    {
+        std::size_t b = 0;
+        for (uint32_t limit = 10; b < LockStatsSnapshot::histogramBuckets - 1 && us >= limit; limit *= 10)
+        {
+            b++;
+        }
+        return b;
+    }
+
+    static void updateMax(std::atomic<uint32_t> &max, uint32_t value)
+    {
+        uint32_t prev = max.load(std::memory_order_relaxed);
+        while (value > prev && !max.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void copy(const Side &from, LockStatsSnapshot::Side &to)
+    {
+        to.attempts = from.attempts.load(std::memory_order_relaxed);
+        to.acquired = from.acquired.load(std::memory_order_relaxed);
+        to.timeouts = from.timeouts.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < LockStatsSnapshot::histogramBuckets; i++)
+        {
+            to.waitHistogram[i] = from.waitHistogram[i].load(std::memory_order_relaxed);
+        }
+        to.maxWaitUs = from.maxWaitUs.load(std::memory_order_relaxed);
+        to.maxHoldUs = from.maxHoldUs.load(std::memory_order_relaxed);
+        to.totalHoldUs = from.totalHoldUs.load(std::memory_order_relaxed);
+    }
+
+    Side m_read{};
+    Side m_write{};
+    std::atomic<TaskHandle_t> m_writer{nullptr};
+};
+
+// Print the statistics with ESP_LOGI
+void logLockStats(const char *tag, const char *name, const LockStatsSnapshot &stats);
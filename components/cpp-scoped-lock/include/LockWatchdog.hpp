@@ -0,0 +1,68 @@
+/*
+ * LockWatchdog.hpp
+ *  Debug aid: flags LockableObject read/write accesses that are held longer than a threshold.
+ *  Compiled in with CONFIG_SCOPED_LOCK_WATCHDOG (menuconfig: Component config -> C++ scoped lock).
+ *
+ *  Every ScopedAccess that owns its lock occupies one slot of a fixed table (object, task, tick of acquisition)
+ *  until it is destroyed. Claiming and releasing a slot is a few atomic operations, no locks and no allocation,
+ *  so it can stay enabled in release builds. A low priority task scans the table and reports holds above the
+ *  threshold, each hold once:
+ *
+ *      LockWatchdog::start(); // i.e. in app_main
+ *
+ *      W (12345) LockWatchdog: write lock on 0x3ffb2c40 held by task 'main' for 1010 ms
+ *
+ *  When all slots are in use, further accesses are not tracked (see untracked()).
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+struct LockHoldReport
+{
+    const void *object; // the LockableObject
+    TaskHandle_t task;  // the task holding the access
+    bool write;
+    uint32_t heldMs;
+};
+
+class LockWatchdog
+{
+public:
+    using Handler = void (*)(const LockHoldReport &report);
+
+    // Called by ScopedAccess once the lock is owned. Returns the slot to pass to leave(), or -1 if the table is full.
+    static int enter(const void *object, bool write);
+    static void leave(int slot);
+
+    // Start the watchdog task (does nothing if it is already running). It checks every thresholdMs / 2.
+    static bool start(uint32_t thresholdMs = defaultThresholdMs, UBaseType_t priority = tskIDLE_PRIORITY + 1);
+
+    // Replace the default report handler (ESP_LOGW). Pass nullptr to restore it.
+    // Runs in the watchdog task (or in the caller of check()), must not block on the reported object.
+    static void setHandler(Handler handler);
+
+    // Scan the table once and report holds longer than thresholdMs that were not reported yet.
+    // Returns the number of new reports. Used by the watchdog task, can be called directly (i.e. from tests), also while
+    // the task runs: each hold is reported once, by whichever check() sees it first.
+    static std::size_t check(uint32_t thresholdMs);
+
+    // Number of accesses that could not be tracked because all slots were in use.
+    static uint32_t untracked();
+
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+    static constexpr std::size_t numSlots = CONFIG_SCOPED_LOCK_WATCHDOG_SLOTS;
+    static constexpr uint32_t defaultThresholdMs = CONFIG_SCOPED_LOCK_WATCHDOG_THRESHOLD_MS;
+#else
+    static constexpr std::size_t numSlots = 0;
+    static constexpr uint32_t defaultThresholdMs = 0;
+#endif
+};
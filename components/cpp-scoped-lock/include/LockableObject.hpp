@@ -7,27 +7,170 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <shared_mutex>
+#include <mutex>
 #include <chrono>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
-template <typename protectedType>
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#if CONFIG_SCOPED_LOCK_STATS
+#include "esp_timer.h"
+#endif
+#include "LockStats.hpp"
+#include "LockWatchdog.hpp"
+
+// How LockableObject drives a mutex policy.
+// Specialize for policies that don't have the std::shared_timed_mutex interface (see PerCoreSharedMutex.hpp).
+//  - tryLock/unlock, tryLockShared/unlockShared: used by ReadAccess/WriteAccess.
+//    read_token is what a read hold has to remember besides the mutex. It is stored in every ReadAccess,
+//    so keep it empty (the default) where possible.
+//  - read_lock/write_lock: scoped lock types, constructible from (mutex&, timeout duration), with owns_lock(),
+//    releasing on destruction. Used by UpgradableAccess.
+template <typename mutexType>
+struct LockTraits
+{
+    using read_lock = std::shared_lock<mutexType>;
+    using write_lock = std::unique_lock<mutexType>;
+
+    struct read_token
+    {
+    };
+
+    template <class Rep, class Period>
+    static bool tryLock(mutexType &m, const std::chrono::duration<Rep, Period> &timeout_duration) { return m.try_lock_for(timeout_duration); }
+    static void unlock(mutexType &m) { m.unlock(); }
+
+    template <class Rep, class Period>
+    static bool tryLockShared(mutexType &m, const std::chrono::duration<Rep, Period> &timeout_duration, read_token &)
+    {
+        return m.try_lock_shared_for(timeout_duration);
+    }
+    static void unlockShared(mutexType &m, read_token &) { m.unlock_shared(); }
+};
+
+// Debug state of a LockableObject access (empty without CONFIG_SCOPED_LOCK_STATS/CONFIG_SCOPED_LOCK_WATCHDOG)
+struct ScopedAccessDebugInfo
+{
+#if CONFIG_SCOPED_LOCK_STATS
+    int64_t since{}; // start of the acquisition, then time of acquisition
+#endif
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+    int watchSlot{-1}; // LockWatchdog slot while the lock is owned
+#endif
+};
+
+// protectedType: the object to protect
+// mutexType: the mutex policy. Must meet the SharedTimedMutex requirements (try_lock_for, try_lock_shared_for, ...).
+//   - std::shared_timed_mutex (default) goes through the pthread layer.
+//   - FreeRtosSharedMutex (FreeRtosSharedMutex.hpp) is built directly on FreeRTOS primitives.
+//   - PerCoreSharedMutex (PerCoreSharedMutex.hpp) keeps one reader count per core, for read-mostly objects on dual-core targets.
+//   - UpgradableMutex<inner> (UpgradableMutex.hpp) wraps another policy and enables getUpgradableAccess().
+template <typename protectedType, typename mutexType = std::shared_timed_mutex>
 class LockableObject
 {
 public:
-    using mutex_type = std::shared_timed_mutex; // shared_timed_mutex to allow timed locks
-    using read_lock = std::shared_lock<mutex_type>; // shared_lock for read access (multiple readers)
-    using write_lock = std::unique_lock<mutex_type>; // unique_lock for write access (exclusive)
+    using mutex_type = mutexType; // must allow timed locks
+    using read_lock = typename LockTraits<mutex_type>::read_lock;   // shared_lock for read access (multiple readers)
+    using write_lock = typename LockTraits<mutex_type>::write_lock; // unique_lock for write access (exclusive)
 
     // Ensure the minimum timeout duration to avoid contention on the mutex
     static constexpr auto minBlockTime = std::chrono::milliseconds(10);
-    static constexpr auto maxBlockTime = std::chrono::milliseconds::max();
+    // "Forever": saturates to portMAX_DELAY in FreeRtosSharedMutex::toTicks(). Not milliseconds::max(), which
+    // overflows in try_lock_for() of the std:: mutexes, so they would give up at once when the lock is busy.
+    static constexpr auto maxBlockTime = std::chrono::milliseconds(portMAX_DELAY);
+#ifdef CONFIG_SCOPED_LOCK_MAX_SUBSCRIBERS
+    static constexpr std::size_t maxSubscribers = CONFIG_SCOPED_LOCK_MAX_SUBSCRIBERS;
+#else
+    static constexpr std::size_t maxSubscribers = 4;
+#endif
+    // A generation() value never reported, to start from in readIfChanged()
+    static constexpr uint32_t noGeneration = 0;
 
 private:
     mutable mutex_type m_mutex{}; // Mutex for protecting access to the object
     protectedType m_protected{}; // The protected object
+#if CONFIG_SCOPED_LOCK_STATS
+    LockStats m_stats{}; // contention statistics, see getStats()
+#endif
+
+    struct NoToken // a write access needs to remember nothing but the owner
+    {
+    };
+
+    // A mutation queued by postWrite()
+    struct PendingWrite
+    {
+        PendingWrite *next{nullptr};
+        virtual void apply(protectedType &obj) = 0;
+        virtual ~PendingWrite() = default;
+    };
+    template <class F>
+    struct PendingWriteOf : PendingWrite
+    {
+        explicit PendingWriteOf(F &&f) : fn{std::move(f)} {}
+        void apply(protectedType &obj) override { fn(obj); }
+        F fn;
+    };
+    std::atomic<PendingWrite *> m_pendingWrites{nullptr}; // lock-free stack, newest first
+
+    // A read queued by whenReadable()
+    struct PendingRead
+    {
+        PendingRead *next{nullptr};
+        virtual void run(const protectedType &obj) = 0;
+        virtual ~PendingRead() = default;
+    };
+    template <class F>
+    struct PendingReadOf : PendingRead
+    {
+        explicit PendingReadOf(F &&f) : fn{std::move(f)} {}
+        void run(const protectedType &obj) override { fn(obj); }
+        F fn;
+    };
+    std::atomic<PendingRead *> m_pendingReads{nullptr}; // lock-free stack, newest first
+
+    struct Subscriber
+    {
+        std::atomic<TaskHandle_t> task{nullptr};
+        std::atomic<uint32_t> bits{0};
+        std::atomic<uint32_t> inFlight{0}; // notifySubscribers() calls that may still notify `task`
+    };
+    std::array<Subscriber, maxSubscribers> m_subscribers{};
+    std::atomic<uint32_t> m_generation{noGeneration + 1}; // bumped by every write, see generation()
+
     static inline LockableObject *sm_instance{}; // Optional static pointer to a single instance of LockableObject<protectedType>
 
 public:
+    LockableObject() = default;
+    LockableObject(const LockableObject &) = delete;
+    LockableObject &operator=(const LockableObject &) = delete;
+
+    ~LockableObject()
+    {
+        for (PendingWrite *w = m_pendingWrites.exchange(nullptr); w;)
+        {
+            PendingWrite *next = w->next;
+            delete w;
+            w = next;
+        }
+        for (PendingRead *r = m_pendingReads.exchange(nullptr); r;)
+        {
+            PendingRead *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
     // Optional Set Static Instance (when used as a singleton)
     static void setStaticInstance(LockableObject *ptr)
     {
@@ -48,21 +191,97 @@ public:
     //write_lock lock_for_writing() { return write_lock(m_mutex); }
     //-- Prefer to only allow access to the protected object using ScopedAccess class
 
+    // Scoped read or write access. Holds only a pointer to the owner (nullptr if the lock wasn't acquired), plus the
+    // policy's read_token and the debug info, which are both empty by default: one word, passed around in a register.
+    // It can't be copied or moved, so getters always construct it in place (guaranteed copy elision).
     template <class objType, class lockType>
-    class ScopedAccess
+    class [[nodiscard]] ScopedAccess
+        : private ScopedAccessDebugInfo,
+          private std::conditional_t<std::is_same<lockType, write_lock>::value, NoToken, typename LockTraits<mutexType>::read_token>
     {
+        static constexpr bool isWrite = std::is_same<lockType, write_lock>::value;
+        using traits = LockTraits<mutex_type>;
+        using token_type = std::conditional_t<isWrite, NoToken, typename traits::read_token>;
+
     public:
         // Constructor with timeout
         template<class Rep, class Period>
-        ScopedAccess(mutex_type &m, objType &obj, const std::chrono::duration<Rep, Period>& timeout_duration)
-            : m_protectedRef{obj},
-              m_lock{m, timeout_duration}
+        ScopedAccess(LockableObject &owner, const std::chrono::duration<Rep, Period>& timeout_duration)
         {
-            // Direct initialization in member initializer list
+#if CONFIG_SCOPED_LOCK_STATS
+            this->since = esp_timer_get_time();
+#endif
+            bool acquired;
+            if constexpr (isWrite)
+            {
+                acquired = traits::tryLock(owner.m_mutex, timeout_duration);
+            }
+            else
+            {
+                acquired = traits::tryLockShared(owner.m_mutex, timeout_duration, token());
+            }
+            m_owner = acquired ? &owner : nullptr;
+#if CONFIG_SCOPED_LOCK_STATS
+            const int64_t now = esp_timer_get_time();
+            owner.m_stats.recordAcquire(isWrite, acquired, now - this->since);
+            SCOPED_LOCK_TRACE_ACQUIRE(&owner, isWrite, acquired, static_cast<uint32_t>(now - this->since));
+            this->since = now; // from now on: the time the lock was acquired
+#endif
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+            if (acquired)
+            {
+                this->watchSlot = LockWatchdog::enter(&owner, isWrite);
+            }
+#endif
         }
 
-        // only allow access to the pointer with -> operator to prevent copying the protected object
-        objType *operator->() const { return &m_protectedRef; }
+        ~ScopedAccess()
+        {
+            if (!m_owner)
+            {
+                return;
+            }
+            LockableObject &owner = *m_owner;
+            if constexpr (isWrite)
+            {
+                owner.applyQueuedWrites(); // batch the updates queued meanwhile into this write
+                owner.bumpGeneration();
+            }
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+            if (this->watchSlot >= 0)
+            {
+                LockWatchdog::leave(this->watchSlot);
+            }
+#endif
+#if CONFIG_SCOPED_LOCK_STATS
+            const int64_t held = esp_timer_get_time() - this->since;
+            owner.m_stats.recordRelease(isWrite, held);
+            SCOPED_LOCK_TRACE_RELEASE(&owner, isWrite, static_cast<uint32_t>(held));
+#endif
+            if constexpr (isWrite)
+            {
+                traits::unlock(owner.m_mutex);
+                owner.notifySubscribers();
+            }
+            else
+            {
+                traits::unlockShared(owner.m_mutex, token());
+            }
+            owner.combineQueued(); // updates and reads queued by postWrite()/whenReadable() while we held the lock
+        }
+
+        ScopedAccess(const ScopedAccess &) = delete;
+        ScopedAccess(ScopedAccess &&) = delete;
+        ScopedAccess &operator=(const ScopedAccess &) = delete;
+        ScopedAccess &operator=(ScopedAccess &&) = delete;
+
+        // only allow access to the pointer with -> operator to prevent copying the protected object.
+        // Check the access first (if (auto access = ...)): a timed out access has no object.
+        objType *operator->() const
+        {
+            assert(m_owner);
+            return &m_owner->m_protected;
+        }
 
         // operator bool
         //  - returns whether the exclusive lock is still active
@@ -70,57 +289,474 @@ public:
         //
         explicit operator bool() const &
         {
-            return m_lock.owns_lock();
+            return m_owner != nullptr;
         }
 
     private:
-        // Reference to the protected resource
-        objType &m_protectedRef;
-        // a scoped lock that exists as long as this instance of ScopedAccess class lives
-        lockType m_lock;
+        token_type &token() { return *this; }
+
+        LockableObject *m_owner; // nullptr if the lock was not acquired
     };
 
     using ReadAccess = ScopedAccess<protectedType, read_lock>;
     using WriteAccess = ScopedAccess<protectedType, write_lock>;
 
+    // Shared access that can be promoted to exclusive access with upgrade(), without releasing in between.
+    // Only available with an UpgradableMutex policy. Other readers share the lock with it,
+    // but there is at most one UpgradableAccess (and no writer) at a time.
+    class UpgradableAccess
+    {
+        using inner_type = typename mutex_type::inner_type;
+        using gate_lock = std::unique_lock<typename mutex_type::gate_type>;
+
+    public:
+        template<class Rep, class Period>
+        UpgradableAccess(LockableObject &owner, const std::chrono::duration<Rep, Period>& timeout_duration)
+            : m_owner{owner},
+              m_gate{owner.m_mutex.gate(), std::defer_lock}
+        {
+            if (mutex_type::lockFor(m_gate, timeout_duration))
+            {
+                // can't block long: writers need the gate, which we hold
+                m_read.emplace(owner.m_mutex.inner(), timeout_duration);
+                if (!m_read->owns_lock())
+                {
+                    m_read.reset();
+                    m_gate.unlock();
+                }
+            }
+        }
+
+        // Promote to exclusive access, waiting up to the timeout for the other readers to leave.
+        // Returns false on timeout, the access is still shared then.
+        template<class Rep, class Period>
+        bool upgrade(const std::chrono::duration<Rep, Period>& timeout_duration)
+        {
+            if (m_write || !m_read)
+            {
+                return bool(m_write);
+            }
+            m_read.reset();
+            m_write.emplace(m_owner.m_mutex.inner(), std::defer_lock);
+            if (!mutex_type::lockFor(*m_write, timeout_duration))
+            {
+                m_write.reset();
+                // can't block: writers need the gate, which we hold
+                m_read.emplace(m_owner.m_mutex.inner(), maxBlockTime);
+                return false;
+            }
+            return true;
+        }
+
+        bool upgrade() { return upgrade(maxBlockTime); }
+
+        ~UpgradableAccess()
+        {
+            const bool wrote = bool(m_write);
+            if (wrote)
+            {
+                m_owner.applyQueuedWrites();
+                m_owner.bumpGeneration();
+            }
+            m_write.reset();
+            m_read.reset();
+            if (m_gate.owns_lock())
+            {
+                m_gate.unlock();
+            }
+            if (wrote)
+            {
+                m_owner.notifySubscribers();
+            }
+            m_owner.combineQueued();
+        }
+
+        bool isUpgraded() const { return bool(m_write); }
+
+        // only allow access to the pointer with -> operator to prevent copying the protected object
+        // (don't modify it before upgrade() returned true)
+        protectedType *operator->() const { return &m_owner.m_protected; }
+
+        explicit operator bool() const &
+        {
+            return m_read || m_write;
+        }
+
+    private:
+        LockableObject &m_owner;
+        gate_lock m_gate; // released last (members are destroyed in reverse order)
+        std::optional<typename LockTraits<inner_type>::read_lock> m_read;
+        std::optional<typename LockTraits<inner_type>::write_lock> m_write;
+    };
+
 
 
     // Returns a read access object with the default timeout duration (10ms).
-    ReadAccess getReadAccess()
+    [[nodiscard]] ReadAccess getReadAccess()
     {
-        return ReadAccess(m_mutex, m_protected, minBlockTime);
+        return ReadAccess(*this, minBlockTime);
     }
 
     // Returns a read access object with the specified timeout duration. It will block until the timeout is reached.
     template<class Rep, class Period>
-    ReadAccess getReadAccess(const std::chrono::duration<Rep, Period>& timeout_duration)
+    [[nodiscard]] ReadAccess getReadAccess(const std::chrono::duration<Rep, Period>& timeout_duration)
     {
         // Ensure the minimum timeout duration to avoid contention on the mutex
         auto actual_timeout = timeout_duration < minBlockTime ? minBlockTime : timeout_duration;
-        return ReadAccess(m_mutex, m_protected, actual_timeout);
+        return ReadAccess(*this, actual_timeout);
     }
 
     // Returns a write access object with the default timeout duration (max).
-    WriteAccess getWriteAccess()
+    [[nodiscard]] WriteAccess getWriteAccess()
     {
-        return WriteAccess(m_mutex, m_protected, maxBlockTime);
+        return WriteAccess(*this, maxBlockTime);
     }
 
     // Returns a write access object with the specified timeout duration. It will block until the timeout is reached.
     template<class Rep, class Period>
-    WriteAccess getWriteAccess(const std::chrono::duration<Rep, Period>& timeout_duration)
+    [[nodiscard]] WriteAccess getWriteAccess(const std::chrono::duration<Rep, Period>& timeout_duration)
+    {
+        // Ensure the minimum timeout duration to avoid contention on the mutex
+        auto actual_timeout = timeout_duration < minBlockTime ? minBlockTime : timeout_duration;
+        return WriteAccess(*this, actual_timeout);
+    }
+
+    // Queue a mutation, to be applied under the write lock without blocking the caller.
+    // fn is called as fn(protectedType&). It runs right away if the lock is free, otherwise the task releasing the lock
+    // applies it, together with all other queued updates, in one write section (flat combining).
+    // So readers are held up once per batch instead of once per update. Updates are applied in the order they were posted.
+    // fn runs in whatever task applies the batch, and must not take locks of this object.
+    template <class F>
+    void postWrite(F &&fn)
+    {
+        PendingWrite *w = new PendingWriteOf<std::decay_t<F>>(std::decay_t<F>(std::forward<F>(fn)));
+        w->next = m_pendingWrites.load(std::memory_order_relaxed);
+        while (!m_pendingWrites.compare_exchange_weak(w->next, w, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+        }
+        combineQueued();
+    }
+
+    // The read counterpart of postWrite(), for event loops that must not wait for a lock.
+    // fn is called as fn(const protectedType&) under a read lock: right away if the lock is available, otherwise
+    // by the task releasing the lock that was in the way, together with the other queued reads. In posting order.
+    // fn runs in whatever task that is, so keep it short and hand what it read over to the caller's loop
+    // (i.e. copy it into an event). It must not take locks of this object.
+    template <class F>
+    void whenReadable(F &&fn)
+    {
+        PendingRead *r = new PendingReadOf<std::decay_t<F>>(std::decay_t<F>(std::forward<F>(fn)));
+        r->next = m_pendingReads.load(std::memory_order_relaxed);
+        while (!m_pendingReads.compare_exchange_weak(r->next, r, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+        }
+        combineQueued();
+    }
+
+    bool hasPendingReads() const
+    {
+        return m_pendingReads.load(std::memory_order_acquire) != nullptr;
+    }
+
+    // Apply all queued updates now, waiting for the write lock up to the timeout. Returns false on timeout.
+    template <class Rep, class Period>
+    bool applyPendingWrites(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return bool(getWriteAccess(timeout_duration)); // the WriteAccess applies them before it releases the lock
+    }
+
+    bool applyPendingWrites()
+    {
+        return applyPendingWrites(maxBlockTime);
+    }
+
+    bool hasPendingWrites() const
+    {
+        return m_pendingWrites.load(std::memory_order_acquire) != nullptr;
+    }
+
+    // Counts the writes, readable without any lock. Bumped when a write access ends, before its lock is released.
+    // To cache something derived from the object: read generation() *before* taking the ReadAccess the value is
+    // computed under, and keep it with the value. As long as generation() still returns it, the object didn't change.
+    uint32_t generation() const
+    {
+        return m_generation.load(std::memory_order_acquire);
+    }
+
+    // Runs fn(const protectedType&) under a read lock, but only if the object changed since `seen` (a generation()
+    // value, or noGeneration for the first time), and then updates `seen`. Returns whether fn ran.
+    // Unchanged objects cost one atomic load instead of a lock round trip.
+    template <class F>
+    bool readIfChanged(uint32_t &seen, F &&fn)
+    {
+        const uint32_t current = generation();
+        if (current == seen)
+        {
+            return false;
+        }
+        if (auto access = getReadAccess())
+        {
+            const protectedType &obj = m_protected;
+            fn(obj);
+            seen = current;
+            return true;
+        }
+        return false;
+    }
+
+    // Wake a task after every write: xTaskNotify(task, bits, eSetBits) once the write lock was released.
+    // Wait for it with xTaskNotifyWait(), then re-read (i.e. MyConfigDb::forEachChangedSince()).
+    // Writes in quick succession may be merged into one wake-up. Returns false if all maxSubscribers
+    // slots (CONFIG_SCOPED_LOCK_MAX_SUBSCRIBERS) are taken.
+    bool subscribe(uint32_t bits, TaskHandle_t task = xTaskGetCurrentTaskHandle())
+    {
+        for (auto &sub : m_subscribers)
+        {
+            TaskHandle_t expected = nullptr;
+            if (sub.task.compare_exchange_strong(expected, task, std::memory_order_acq_rel))
+            {
+                sub.bits.store(bits, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Stop notifying the task. Call it before deleting the task: it returns once no notification to it is on its
+    // way any more (waiting a tick at a time for a notifier that was preempted in between).
+    void unsubscribe(TaskHandle_t task = xTaskGetCurrentTaskHandle())
+    {
+        for (auto &sub : m_subscribers)
+        {
+            if (sub.task.load(std::memory_order_acquire) == task)
+            {
+                sub.bits.store(0, std::memory_order_relaxed);
+                sub.task.store(nullptr, std::memory_order_seq_cst);
+                // a notifier counts itself in before it loads the task, so it either saw nullptr or is counted here
+                while (sub.inFlight.load(std::memory_order_seq_cst) != 0)
+                {
+                    vTaskDelay(1);
+                }
+            }
+        }
+    }
+
+    // Returns an upgradable access object with the default timeout duration (max), like getWriteAccess().
+    [[nodiscard]] UpgradableAccess getUpgradableAccess()
+    {
+        return UpgradableAccess(*this, maxBlockTime);
+    }
+
+    // Returns an upgradable access object with the specified timeout duration. It will block until the timeout is reached.
+    template<class Rep, class Period>
+    [[nodiscard]] UpgradableAccess getUpgradableAccess(const std::chrono::duration<Rep, Period>& timeout_duration)
     {
         // Ensure the minimum timeout duration to avoid contention on the mutex
         auto actual_timeout = timeout_duration < minBlockTime ? minBlockTime : timeout_duration;
-        return WriteAccess(m_mutex, m_protected, actual_timeout);
+        return UpgradableAccess(*this, actual_timeout);
+    }
+
+    // Returns a copy of the contention statistics (all zero and enabled == false without CONFIG_SCOPED_LOCK_STATS).
+    LockStatsSnapshot getStats() const
+    {
+#if CONFIG_SCOPED_LOCK_STATS
+        return m_stats.snapshot();
+#else
+        return LockStatsSnapshot{};
+#endif
+    }
+
+    // Restart the statistics from zero
+    void clearStats()
+    {
+#if CONFIG_SCOPED_LOCK_STATS
+        m_stats.clear();
+#endif
     }
 
     // Clear the protected object, effectively resetting it.
+    // Only a swap with a default-constructed object is done under the write lock (a few pointers for the standard
+    // containers, which don't allocate when default-constructed). The old object is destroyed after the lock is
+    // released, so i.e. a std::map frees its nodes while readers already go on.
     void reset(void)
+    {
+        protectedType old = exchange(protectedType{});
+    } // old is destroyed here
+
+    // Swap `replacement` in under the write lock and return the old object, to destroy it wherever it suits
+    // (i.e. hand it to a low priority task). Returns `replacement` itself if the lock was not acquired.
+    // A type with a swapContents(protectedType &) member swaps with that instead, so it can keep what belongs to
+    // the object rather than to its contents (i.e. MyConfigDb keeps its defaults and its revision counting on).
+    [[nodiscard]] protectedType exchange(protectedType replacement)
+    {
+        if (auto lock = getWriteAccess())
+        {
+            swapIn(m_protected, replacement, 0);
+        }
+        return replacement;
+    }
+
+    // Empty the protected object in place with its clear(), under the write lock. Unlike reset() it keeps the
+    // allocated capacity (i.e. of a FlatMap, or of a pool-based container), for an object that is filled again soon.
+    // Only for types with a clear() member.
+    template <class U = protectedType>
+    auto clear() -> decltype(std::declval<U &>().clear(), void())
     {
         if (auto lock = getWriteAccess())
         {
-            m_protected = {}; // Clear the protected object. I hope this properly deconstructs the old object.
+            lock->clear();
+        }
+    }
+
+private:
+    template <class U>
+    static auto swapIn(U &held, U &replacement, int) -> decltype(held.swapContents(replacement), void())
+    {
+        held.swapContents(replacement);
+    }
+    template <class U>
+    static void swapIn(U &held, U &replacement, long)
+    {
+        using std::swap;
+        swap(held, replacement);
+    }
+
+    // Run the queued updates, oldest first. Called with the write lock held.
+    void applyQueuedWrites()
+    {
+        PendingWrite *w = m_pendingWrites.exchange(nullptr, std::memory_order_acquire);
+        PendingWrite *fifo = nullptr;
+        while (w)
+        {
+            PendingWrite *next = w->next;
+            w->next = fifo;
+            fifo = w;
+            w = next;
+        }
+        while (fifo)
+        {
+            PendingWrite *next = fifo->next;
+            fifo->apply(m_protected);
+            delete fifo;
+            fifo = next;
+        }
+    }
+
+    // Run the queued reads, oldest first. Called with a read lock held.
+    void runQueuedReads()
+    {
+        PendingRead *r = m_pendingReads.exchange(nullptr, std::memory_order_acquire);
+        PendingRead *fifo = nullptr;
+        while (r)
+        {
+            PendingRead *next = r->next;
+            r->next = fifo;
+            fifo = r;
+            r = next;
+        }
+        while (fifo)
+        {
+            PendingRead *next = fifo->next;
+            fifo->run(m_protected);
+            delete fifo;
+            fifo = next;
+        }
+    }
+
+    // Become the combiner if there are queued updates or reads and the lock is available. Called without holding
+    // the lock. If the lock is busy, its holder picks them up when it releases it. Checks both queues again after
+    // each release, as whatever was queued meanwhile found the lock taken by this task.
+    void combineQueued()
+    {
+        using traits = LockTraits<mutex_type>;
+        for (;;)
+        {
+            if (m_pendingWrites.load(std::memory_order_seq_cst) && traits::tryLock(m_mutex, std::chrono::milliseconds(0)))
+            {
+                {
+                    CombinerHold hold{*this, true};
+                    applyQueuedWrites();
+                    bumpGeneration();
+                }
+                traits::unlock(m_mutex);
+                notifySubscribers();
+                continue;
+            }
+            typename traits::read_token token{};
+            if (m_pendingReads.load(std::memory_order_seq_cst) && traits::tryLockShared(m_mutex, std::chrono::milliseconds(0), token))
+            {
+                {
+                    CombinerHold hold{*this, false};
+                    runQueuedReads();
+                }
+                traits::unlockShared(m_mutex, token);
+                continue;
+            }
+            return;
+        }
+    }
+
+    // The statistics and watchdog of a lock combineQueued() took, like a ScopedAccess keeps them for its holder.
+    // Only successful acquisitions count: the combiner doesn't wait, and a busy lock is not a timeout.
+    class CombinerHold : private ScopedAccessDebugInfo
+    {
+    public:
+        CombinerHold(LockableObject &owner, bool isWrite) : m_owner{owner}, m_isWrite{isWrite}
+        {
+#if CONFIG_SCOPED_LOCK_STATS
+            owner.m_stats.recordAcquire(isWrite, true, 0);
+            SCOPED_LOCK_TRACE_ACQUIRE(&owner, isWrite, true, 0);
+            this->since = esp_timer_get_time();
+#endif
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+            this->watchSlot = LockWatchdog::enter(&owner, isWrite);
+#endif
+        }
+
+        ~CombinerHold()
+        {
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+            if (this->watchSlot >= 0)
+            {
+                LockWatchdog::leave(this->watchSlot);
+            }
+#endif
+#if CONFIG_SCOPED_LOCK_STATS
+            const int64_t held = esp_timer_get_time() - this->since;
+            m_owner.m_stats.recordRelease(m_isWrite, held);
+            SCOPED_LOCK_TRACE_RELEASE(&m_owner, m_isWrite, static_cast<uint32_t>(held));
+#endif
+        }
+
+        CombinerHold(const CombinerHold &) = delete;
+        CombinerHold &operator=(const CombinerHold &) = delete;
+
+    private:
+        [[maybe_unused]] LockableObject &m_owner;
+        [[maybe_unused]] const bool m_isWrite;
+    };
+
+    void bumpGeneration()
+    {
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void notifySubscribers()
+    {
+        for (auto &sub : m_subscribers)
+        {
+            if (!sub.task.load(std::memory_order_relaxed))
+            {
+                continue; // free slot
+            }
+            sub.inFlight.fetch_add(1, std::memory_order_seq_cst);
+            TaskHandle_t task = sub.task.load(std::memory_order_seq_cst);
+            const uint32_t bits = sub.bits.load(std::memory_order_acquire);
+            if (task && bits)
+            {
+                xTaskNotify(task, bits, eSetBits);
+            }
+            sub.inFlight.fetch_sub(1, std::memory_order_release);
         }
     }
 };
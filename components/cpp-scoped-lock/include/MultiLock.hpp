@@ -0,0 +1,212 @@
+/*
+ * MultiLock.hpp
+ *  Write access to several lockable objects at once, without deadlocks:
+ *
+ *      if (auto all = lockAll(MyConfigDbManager::getInstance(), otherMan, thirdMan, std::chrono::milliseconds(100)))
+ *      {
+ *          all.get<0>()->settings["a"] = "1";
+ *          all.get<1>()->counter++;
+ *      }   // all released together
+ *
+ *  Works with any object type that has a WriteAccess constructible from (object&, timeout), i.e. LockableObject,
+ *  SeqLockableObject and SnapshotLockableObject, also mixed.
+ *
+ *  The locks are always taken in the same global order (by object address), so two lockAll() calls on
+ *  overlapping sets can't deadlock each other. Code that nests getWriteAccess() by hand in another order still
+ *  could, so only the first lock waits for the whole remaining time: the others wait at most backoffSlice, and
+ *  if one of them isn't available, everything acquired so far is released, the task backs off (1, 2, 4, 8 ticks)
+ *  and starts over. The timeout covers all attempts together; the last attempt may overrun it by up to
+ *  (number of objects - 1) * backoffSlice.
+ *  Without a timeout argument, lockAll() retries until it gets all locks.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "FreeRtosSharedMutex.hpp"
+
+template <class... Objs>
+class MultiWriteAccess
+{
+    static_assert(sizeof...(Objs) > 0, "lockAll() needs at least one object");
+    static constexpr std::size_t count = sizeof...(Objs);
+
+public:
+    // How long each lock after the first one is waited for, before backing off
+    static constexpr auto backoffSlice = std::chrono::milliseconds(10);
+    static constexpr TickType_t maxBackoffTicks = 8;
+
+    template <class Rep, class Period>
+    MultiWriteAccess(Objs &...objs, const std::chrono::duration<Rep, Period> &timeout_duration)
+        : m_objs{objs...}
+    {
+        const void *addresses[count] = {static_cast<const void *>(&objs)...};
+        for (std::size_t i = 0; i < count; i++)
+        {
+            m_order[i] = i;
+        }
+        std::sort(m_order.begin(), m_order.end(),
+                  [&addresses](std::size_t a, std::size_t b) { return std::less<const void *>()(addresses[a], addresses[b]); });
+        for (std::size_t k = 1; k < count; k++)
+        {
+            assert(addresses[m_order[k - 1]] != addresses[m_order[k]]); // the same object twice would deadlock on itself
+        }
+        acquire(FreeRtosSharedMutex::toTicks(timeout_duration));
+    }
+
+    ~MultiWriteAccess()
+    {
+        releaseFirst(m_held);
+    }
+
+    MultiWriteAccess(const MultiWriteAccess &) = delete;
+    MultiWriteAccess &operator=(const MultiWriteAccess &) = delete;
+
+    // The WriteAccess of the I-th object, in the order they were passed to lockAll()
+    template <std::size_t I>
+    auto &get()
+    {
+        return *std::get<I>(m_access);
+    }
+
+    // operator bool
+    //  - returns whether all locks are held
+    //  - enables use in 'if' expression to introduce local scope
+    explicit operator bool() const &
+    {
+        return m_held == count;
+    }
+
+private:
+    template <std::size_t I>
+    using access_type = typename std::tuple_element_t<I, std::tuple<Objs...>>::WriteAccess;
+
+    static std::chrono::milliseconds toDuration(TickType_t ticks)
+    {
+        return ticks == portMAX_DELAY ? std::chrono::milliseconds(portMAX_DELAY) // forever, see LockableObject::maxBlockTime
+                                      : std::chrono::milliseconds(static_cast<int64_t>(ticks) * portTICK_PERIOD_MS);
+    }
+
+    void acquire(TickType_t ticks)
+    {
+        const TickType_t start = xTaskGetTickCount();
+        const TickType_t slice = FreeRtosSharedMutex::toTicks(backoffSlice);
+        TickType_t backoff = 1;
+        for (;;)
+        {
+            const TickType_t elapsed = xTaskGetTickCount() - start;
+            const TickType_t remaining = (ticks == portMAX_DELAY) ? portMAX_DELAY : (elapsed < ticks ? ticks - elapsed : 0);
+            while (m_held < count && acquireAt(m_order[m_held], toDuration(m_held == 0 ? remaining : slice)))
+            {
+                m_held++;
+            }
+            if (m_held == count)
+            {
+                return;
+            }
+            releaseFirst(m_held);
+            if (remaining == 0 || (ticks != portMAX_DELAY && xTaskGetTickCount() - start >= ticks))
+            {
+                return; // timed out
+            }
+            vTaskDelay(std::min(backoff, remaining));
+            backoff = std::min<TickType_t>(backoff * 2, maxBackoffTicks);
+        }
+    }
+
+    // Try to get the WriteAccess of object i (index in the constructor's argument order)
+    bool acquireAt(std::size_t i, std::chrono::milliseconds timeout)
+    {
+        return acquireAt(i, timeout, std::make_index_sequence<count>{});
+    }
+
+    template <std::size_t... I>
+    bool acquireAt(std::size_t i, std::chrono::milliseconds timeout, std::index_sequence<I...>)
+    {
+        return ((i == I && emplaceAccess<I>(timeout)) || ...);
+    }
+
+    template <std::size_t I>
+    bool emplaceAccess(std::chrono::milliseconds timeout)
+    {
+        auto &access = std::get<I>(m_access);
+        access.emplace(std::get<I>(m_objs), timeout);
+        if (!*access)
+        {
+            access.reset();
+            return false;
+        }
+        return true;
+    }
+
+    // Release the first n locks of the acquisition order, in reverse order
+    void releaseFirst(std::size_t n)
+    {
+        while (n > 0)
+        {
+            resetAt(m_order[--n], std::make_index_sequence<count>{});
+        }
+        m_held = 0;
+    }
+
+    template <std::size_t... I>
+    void resetAt(std::size_t i, std::index_sequence<I...>)
+    {
+        ((i == I ? (std::get<I>(m_access).reset(), true) : false) || ...);
+    }
+
+    template <std::size_t... I>
+    static auto makeAccessTuple(std::index_sequence<I...>) -> std::tuple<std::optional<access_type<I>>...>;
+
+    std::tuple<Objs &...> m_objs;
+    decltype(makeAccessTuple(std::make_index_sequence<count>{})) m_access{};
+    std::array<std::size_t, count> m_order{}; // acquisition order (by address)
+    std::size_t m_held{0};                     // number of locks held, in acquisition order
+};
+
+// Helpers for lockAll(): split off the optional trailing timeout.
+struct LockAllArgs
+{
+    template <class T>
+    struct isDuration : std::false_type
+    {
+    };
+    template <class Rep, class Period>
+    struct isDuration<std::chrono::duration<Rep, Period>> : std::true_type
+    {
+    };
+
+    template <class Tuple, std::size_t... I>
+    static auto withTimeout(Tuple &&args, std::index_sequence<I...>)
+    {
+        return MultiWriteAccess<std::remove_reference_t<std::tuple_element_t<I, std::decay_t<Tuple>>>...>(
+            std::get<I>(args)..., std::get<sizeof...(I)>(args));
+    }
+};
+
+// Write access to all objects, see the top of this file. The last argument may be a timeout (std::chrono duration).
+template <class... Args>
+auto lockAll(Args &&...args)
+{
+    using Last = std::decay_t<std::tuple_element_t<sizeof...(Args) - 1, std::tuple<Args...>>>;
+    if constexpr (LockAllArgs::isDuration<Last>::value)
+    {
+        return LockAllArgs::withTimeout(std::forward_as_tuple(std::forward<Args>(args)...), std::make_index_sequence<sizeof...(Args) - 1>{});
+    }
+    else
+    {
+        return MultiWriteAccess<std::remove_reference_t<Args>...>(args..., std::chrono::milliseconds(portMAX_DELAY));
+    }
+}
@@ -6,19 +6,144 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <vector>
-#include <map>
+#include <string>
+#include <string_view>
+#include <optional>
 #include <memory>
 
+#include "ConfigAllocator.hpp"
+#include "ConfigBlob.hpp"
+#include "FlatMap.hpp"
+#include "SettingKey.hpp"
 #include "LockableObject.hpp"
+#include "SnapshotLockableObject.hpp"
+#include "UpgradableMutex.hpp"
 
 /**
  * Represents the contents of the database
+ *
+ * Two layers: an optional read-only blob of defaults (setDefaults(), i.e. factory settings in a memory-mapped
+ * flash partition, looked up in place), and on top of it `settings`, which only holds the keys set at runtime.
  */
 struct MyConfigDb
 {
-    std::map<std::string, std::string> settings; // Example settings map
+    // Sorted flat vector instead of std::map: one contiguous block, no node allocation per key.
+    // Keys are ordered by (hash, name), see SettingKey.hpp. So iteration order is not alphabetical.
+    // The block and the values come from the allocators in use when the database is created, see ConfigAllocator.hpp.
+    using settings_type = FlatMap<SettingName, ConfigString, SettingName::Less,
+                                  ConfigAllocatorRef<std::pair<SettingName, ConfigString>, ConfigAllocator::Role::Index>>;
+    settings_type settings; // the overlay: keys that differ from the defaults
+
+    // A name and a value for `settings`, from the allocator this database was created with (operator[] of
+    // `settings` takes the one in use at the time instead)
+    SettingName makeName(SettingKey key) const { return SettingName(key, m_valueAllocator); }
+    ConfigString makeValue(std::string_view value) const { return ConfigString(value, m_valueAllocator); }
+
+    // Use a ConfigBlob (written with serialize(out, dictionary, true) for a binary search) as the bottom layer.
+    // Nothing is copied, the blob must stay mapped as long as this object (and its copies) exist.
+    void setDefaults(const ConfigBlobView &defaults) { m_defaults = defaults; }
+    const ConfigBlobView &defaults() const { return m_defaults; }
+
+    // Lookup by (preferably constexpr) hashed key, in `settings`, then the defaults. Returns nullopt if neither has it.
+    // The view points into the settings, so it is only valid as long as the access is held.
+    // A const char* or std::string_view converts to a SettingKey without allocating (hashed at runtime),
+    // so none of the getters below allocate heap memory.
+    std::optional<std::string_view> get(SettingKey key) const;
+    bool contains(SettingKey key) const;
+
+    // Typed getters. Return nullopt if the key is not set, or its value does not parse completely.
+    std::optional<int32_t> getInt(SettingKey key) const;     // decimal, or hex with 0x prefix
+    std::optional<bool> getBool(SettingKey key) const;       // 1/0, true/false, on/off, yes/no (any case)
+    std::optional<float> getFloat(SettingKey key) const;
+    // The parsers of the typed getters
+    static std::optional<int32_t> parseInt(std::string_view text);
+    static std::optional<bool> parseBool(std::string_view text);
+    static std::optional<float> parseFloat(std::string_view text);
+    // Insert or overwrite a setting. Setting the default value drops the key from `settings` instead.
+    void set(SettingKey key, std::string_view value);
+    // Returns whether the setting existed in `settings`. Defaults can't be erased, their value shows again.
+    bool erase(SettingKey key);
+    // erase() every key of `settings`, keeping its capacity (see LockableObject::clear()). The defaults stay.
+    void clear();
+    // Exchange `settings` (and the allocator of their values) with those of `other`, for LockableObject::exchange()
+    // and reset(). The defaults and the change tracking stay: the keys of both count as changed (set or erased), so
+    // i.e. ConfigDbStore writes the swap to flash. `other` gets the old settings, untracked.
+    void swapContents(MyConfigDb &other);
+
+    // Calls fn(SettingKey, std::string_view value) for every setting of both layers (overridden defaults once,
+    // with the value of `settings`): first the defaults, then `settings`.
+    template <class F>
+    void forEachSetting(F &&fn) const
+    {
+        m_defaults.forEach([this, &fn](std::string_view name, std::string_view value) {
+            const SettingKey key{name};
+            if (!settings.contains(key))
+            {
+                fn(key, value);
+            }
+        });
+        for (const auto &entry : settings)
+        {
+            fn(entry.first.key(), std::string_view(entry.second));
+        }
+    }
+
+    // Append `settings` (not the defaults) in the binary format of ConfigBlob.hpp to `out`. With `dictionary`, values
+    // that repeat are stored once, with `index` the blob can be searched in place. A snapshot serializes without a lock.
+    void serialize(std::vector<uint8_t> &out, bool dictionary = true, bool index = false) const;
+    // set() every entry of the blob, in one pass (keys that are not in the blob are kept).
+    // Returns false, and changes nothing, if the blob is not valid().
+    bool load(const ConfigBlobView &blob);
+
+    // Change tracking, i.e. for tasks woken by LockableObject::subscribe(): set() and erase() stamp the key with
+    // a new revision (direct edits of `settings` are not tracked). A subscriber remembers revision() after reading,
+    // and next time only looks at what changed since then.
+    uint32_t revision() const { return m_revision; }
+    // Revision of the last set()/erase() of `key`, 0 if it was never changed
+    uint32_t changedAt(SettingKey key) const;
+
+    // Calls fn(SettingKey, std::optional<std::string_view> value) for every key set or erased after revision `since`.
+    // value is nullopt for erased keys. Returns false, and calls nothing, if changes after `since` were already
+    // forgotten (see forgetChangesUpTo()): re-read everything with forEachSetting() then.
+    template <class F>
+    bool forEachChangedSince(uint32_t since, F &&fn) const
+    {
+        if (since < m_forgottenUpTo)
+        {
+            return false;
+        }
+        for (const auto &change : m_changes)
+        {
+            if (change.second > since)
+            {
+                fn(change.first.key(), get(change.first.key()));
+            }
+        }
+        return true;
+    }
+
+    // Drop the records of the changes up to revision `upTo`, once every reader of forEachChangedSince() has seen them
+    // (ConfigDbStore does it after each flush). Otherwise there is one record for every key ever set or erased.
+    // changedAt() of a forgotten key is 0.
+    void forgetChangesUpTo(uint32_t upTo);
+    // The changes after this revision are all recorded
+    uint32_t forgottenUpTo() const { return m_forgottenUpTo; }
+
+private:
+    void stamp(SettingKey key);
+
+    ConfigBlobView m_defaults;
+    ConfigString::allocator_type m_valueAllocator{}; // the one in use when the database was created
+    FlatMap<SettingName, uint32_t, SettingName::Less> m_changes; // revision of the last set()/erase() per key
+    uint32_t m_revision{0};
+    uint32_t m_forgottenUpTo{0};
 };
 
 using MyConfigDbManager = LockableObject<MyConfigDb>;
+// Never-blocking snapshot reads, copy-on-write updates. For when settings are read often and changed rarely.
+using MyConfigDbSnapshotManager = SnapshotLockableObject<MyConfigDb>;
+// Adds getUpgradableAccess(): check, then write if needed, without releasing the lock in between.
+using MyConfigDbUpgradableManager = LockableObject<MyConfigDb, UpgradableMutex<>>;
 
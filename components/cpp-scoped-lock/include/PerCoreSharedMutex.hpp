@@ -0,0 +1,216 @@
+/*
+ * PerCoreSharedMutex.hpp
+ *  "Big-reader" lock for LockableObject: one reader count per CPU core, each on its own cache line.
+ *
+ *      using MyConfigDbManager = LockableObject<MyConfigDb, PerCoreSharedMutex>;
+ *
+ *  A reader only touches the counter of the core it runs on, so readers on different cores don't bounce
+ *  a shared cache line and read throughput scales with the number of cores.
+ *  The price is paid by writers, which have to sweep all counters and wait for each of them to drain.
+ *  Use it for objects that are read a lot more often than they are written.
+ *
+ *  Writers serialize on a FreeRTOS mutex (priority inheritance), and readers arriving while a writer is
+ *  active queue on that same mutex.
+ *
+ *  A read hold has to remember which counter it incremented (the task may migrate to the other core while
+ *  holding it), so this policy comes with its own LockTraits: the slot is the read_token of a ReadAccess.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "FreeRtosSharedMutex.hpp"
+#include "LockableObject.hpp"
+
+class PerCoreSharedMutex
+{
+public:
+    static constexpr std::size_t cacheLineSize = 64;
+    static constexpr std::size_t numSlots = portNUM_PROCESSORS;
+
+    PerCoreSharedMutex()
+        : m_writerMutex{xSemaphoreCreateMutexStatic(&m_writerMutexBuffer)},
+          m_readerLeft{xSemaphoreCreateBinaryStatic(&m_readerLeftBuffer)}
+    {
+    }
+
+    ~PerCoreSharedMutex()
+    {
+        vSemaphoreDelete(m_readerLeft);
+        vSemaphoreDelete(m_writerMutex);
+    }
+
+    PerCoreSharedMutex(const PerCoreSharedMutex &) = delete;
+    PerCoreSharedMutex &operator=(const PerCoreSharedMutex &) = delete;
+
+    //-- Exclusive (writer) side. Same interface as std::shared_timed_mutex, so std::unique_lock works.
+
+    void lock() { try_lock_for_ticks(portMAX_DELAY); }
+    bool try_lock() { return try_lock_for_ticks(0); }
+
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return try_lock_for_ticks(FreeRtosSharedMutex::toTicks(timeout_duration));
+    }
+
+    void unlock()
+    {
+        m_writer.store(false, std::memory_order_release);
+        xSemaphoreGive(m_writerMutex);
+    }
+
+    //-- Shared (reader) side. The slot returned on success must be passed back to unlock_shared().
+
+    template <class Rep, class Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout_duration, std::size_t &slot)
+    {
+        return try_lock_shared_for_ticks(FreeRtosSharedMutex::toTicks(timeout_duration), slot);
+    }
+
+    void unlock_shared(std::size_t slot)
+    {
+        m_slots[slot].readers.fetch_sub(1, std::memory_order_seq_cst);
+        if (m_writer.load(std::memory_order_seq_cst))
+        {
+            xSemaphoreGive(m_readerLeft); // let the writer re-check the counters
+        }
+    }
+
+    // Scoped read lock, used by LockableObject through LockTraits<PerCoreSharedMutex>.
+    class ReadLock
+    {
+    public:
+        template <class Rep, class Period>
+        ReadLock(PerCoreSharedMutex &m, const std::chrono::duration<Rep, Period> &timeout_duration)
+            : m_mutex{&m}
+        {
+            m_owns = m.try_lock_shared_for(timeout_duration, m_slot);
+        }
+
+        ~ReadLock()
+        {
+            if (m_owns)
+            {
+                m_mutex->unlock_shared(m_slot);
+            }
+        }
+
+        ReadLock(ReadLock &&other) noexcept : m_mutex{other.m_mutex}, m_slot{other.m_slot}, m_owns{other.m_owns}
+        {
+            other.m_owns = false;
+        }
+        ReadLock(const ReadLock &) = delete;
+        ReadLock &operator=(const ReadLock &) = delete;
+
+        bool owns_lock() const noexcept { return m_owns; }
+
+    private:
+        PerCoreSharedMutex *m_mutex;
+        std::size_t m_slot{};
+        bool m_owns{false};
+    };
+
+private:
+    struct alignas(cacheLineSize) Slot
+    {
+        std::atomic<int32_t> readers{0};
+    };
+
+    static std::size_t currentSlot()
+    {
+        return static_cast<std::size_t>(xPortGetCoreID()) % numSlots;
+    }
+
+    int32_t totalReaders() const
+    {
+        int32_t total = 0;
+        for (const auto &s : m_slots)
+        {
+            total += s.readers.load(std::memory_order_seq_cst);
+        }
+        return total;
+    }
+
+    bool try_lock_shared_for_ticks(TickType_t ticks, std::size_t &slot)
+    {
+        // Fast path: announce ourselves on the local counter, then check for a writer.
+        // Paired with the writer setting m_writer before sweeping the counters (both seq_cst),
+        // either we see the writer, or the writer sees us.
+        slot = currentSlot();
+        m_slots[slot].readers.fetch_add(1, std::memory_order_seq_cst);
+        if (!m_writer.load(std::memory_order_seq_cst))
+        {
+            return true;
+        }
+        // A writer is active: back off, and queue behind it on the writer mutex.
+        unlock_shared(slot);
+        if (pdTRUE != xSemaphoreTake(m_writerMutex, ticks))
+        {
+            return false;
+        }
+        slot = currentSlot();
+        m_slots[slot].readers.fetch_add(1, std::memory_order_seq_cst); // no writer can be active while we hold the writer mutex
+        xSemaphoreGive(m_writerMutex);
+        return true;
+    }
+
+    bool try_lock_for_ticks(TickType_t ticks)
+    {
+        const TickType_t start = xTaskGetTickCount();
+        if (pdTRUE != xSemaphoreTake(m_writerMutex, ticks))
+        {
+            return false;
+        }
+        xSemaphoreTake(m_readerLeft, 0); // drop a stale wake-up from a previous writer
+        m_writer.store(true, std::memory_order_seq_cst);
+        while (totalReaders() != 0)
+        {
+            const TickType_t elapsed = xTaskGetTickCount() - start;
+            const TickType_t remaining = (ticks == portMAX_DELAY) ? portMAX_DELAY : (elapsed < ticks ? ticks - elapsed : 0);
+            if (pdTRUE != xSemaphoreTake(m_readerLeft, remaining) && totalReaders() != 0)
+            {
+                unlock();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Slot m_slots[numSlots]{};
+    std::atomic<bool> m_writer{false};
+    StaticSemaphore_t m_writerMutexBuffer{};
+    StaticSemaphore_t m_readerLeftBuffer{};
+    SemaphoreHandle_t m_writerMutex;
+    SemaphoreHandle_t m_readerLeft;
+};
+
+template <>
+struct LockTraits<PerCoreSharedMutex>
+{
+    using read_lock = PerCoreSharedMutex::ReadLock;
+    using write_lock = std::unique_lock<PerCoreSharedMutex>;
+
+    struct read_token
+    {
+        std::size_t slot;
+    };
+
+    template <class Rep, class Period>
+    static bool tryLock(PerCoreSharedMutex &m, const std::chrono::duration<Rep, Period> &timeout_duration) { return m.try_lock_for(timeout_duration); }
+    static void unlock(PerCoreSharedMutex &m) { m.unlock(); }
+
+    template <class Rep, class Period>
+    static bool tryLockShared(PerCoreSharedMutex &m, const std::chrono::duration<Rep, Period> &timeout_duration, read_token &token)
+    {
+        return m.try_lock_shared_for(timeout_duration, token.slot);
+    }
+    static void unlockShared(PerCoreSharedMutex &m, read_token &token) { m.unlock_shared(token.slot); }
+};
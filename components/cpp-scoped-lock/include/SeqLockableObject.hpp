@@ -0,0 +1,254 @@
+/*
+ * SeqLockableObject.hpp
+ *  Sequence-lock (optimistic read) variant of LockableObject for small, trivially copyable types.
+ *
+ *  Readers never write to shared state: they copy the protected object out and retry if a writer
+ *  touched it in the meantime (detected by a sequence counter). So readers on both cores don't bounce
+ *  a cache line between each other like they do with the reader count of a shared mutex.
+ *  Writers are serialized by a mutex and bump the sequence counter before and after modifying.
+ *
+ *  The API mirrors LockableObject, so call sites look the same:
+ *
+ *      if (auto snap = MySensorManager::getInstance().getReadAccess()) // a consistent copy
+ *      {
+ *          use(snap->temperature);
+ *      }
+ *
+ *  Note: ReadAccess holds a copy, so keep protectedType small. Keep write sections short too,
+ *  because readers retry (and eventually yield) for as long as a writer is active.
+ */
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "LockableObject.hpp"
+
+template <typename protectedType, typename writerMutexType = std::timed_mutex>
+class SeqLockableObject
+{
+    static_assert(std::is_trivially_copyable<protectedType>::value, "SeqLockableObject requires a trivially copyable type");
+
+public:
+    using mutex_type = writerMutexType; // serializes writers only, readers never touch it
+    using write_lock = std::unique_lock<mutex_type>;
+
+    static constexpr auto minBlockTime = std::chrono::milliseconds(10);
+    static constexpr auto maxBlockTime = std::chrono::milliseconds(portMAX_DELAY); // see LockableObject::maxBlockTime
+    // number of optimistic read attempts before a reader yields the CPU to let a (maybe lower priority) writer finish
+    static constexpr int readSpinCount = 16;
+    // default number of attempts of tryReadFromISR()
+    static constexpr int isrReadAttempts = 4;
+
+private:
+    mutable mutex_type m_writerMutex{};
+    std::atomic<uint32_t> m_seq{0}; // odd while a writer is modifying m_protected
+    protectedType m_protected{};
+    static inline SeqLockableObject *sm_instance{};
+
+public:
+    // Optional Set Static Instance (when used as a singleton)
+    static void setStaticInstance(SeqLockableObject *ptr)
+    {
+        sm_instance = ptr;
+    };
+    // Optional Get Static Instance (when used as a singleton)
+    static SeqLockableObject &getInstance()
+    {
+        assert(sm_instance); // Dependency must be provided before use!
+        return *sm_instance;
+    };
+
+    // Holds a consistent copy of the protected object.
+    class ReadAccess
+    {
+    public:
+        // only const access, modifying the copy would be pointless
+        const protectedType *operator->() const { return &m_copy; }
+        const protectedType &operator*() const { return m_copy; }
+
+        // returns whether a consistent copy was obtained
+        explicit operator bool() const & { return m_valid; }
+
+    private:
+        friend class SeqLockableObject;
+        protectedType m_copy{};
+        bool m_valid{false};
+    };
+
+    // Exclusive access to the protected object. Readers retry until this is destroyed.
+    class WriteAccess
+    {
+    public:
+        template <class Rep, class Period>
+        WriteAccess(SeqLockableObject &owner, const std::chrono::duration<Rep, Period> &timeout_duration)
+            : m_owner{owner},
+              m_lock{owner.m_writerMutex, timeout_duration}
+        {
+            if (m_lock.owns_lock())
+            {
+                m_owner.beginWrite();
+            }
+        }
+
+        ~WriteAccess()
+        {
+            if (m_lock.owns_lock())
+            {
+                m_owner.endWrite();
+            }
+        }
+
+        WriteAccess(const WriteAccess &) = delete;
+        WriteAccess &operator=(const WriteAccess &) = delete;
+
+        // only allow access to the pointer with -> operator to prevent copying the protected object
+        protectedType *operator->() const { return &m_owner.m_protected; }
+
+        // returns whether the exclusive lock is still active
+        explicit operator bool() const & { return m_lock.owns_lock(); }
+
+    private:
+        SeqLockableObject &m_owner;
+        write_lock m_lock;
+    };
+
+    // Make one optimistic read attempt. Returns false if a writer was active (out is then unspecified).
+    bool tryRead(protectedType &out) const
+    {
+        return readOnce(out);
+    }
+
+    // Read from an interrupt handler: never blocks, gives up after a few attempts if a writer is active.
+    // Retrying only helps against a writer on the other core: a writer interrupted on this core can't
+    // finish before the ISR returns, so this fails for as long as the ISR runs. Returns false then (out is unspecified).
+    // Always inlined, so it ends up in IRAM together with an IRAM_ATTR handler. For that, the object itself must
+    // be in internal RAM too (not in PSRAM).
+    __attribute__((always_inline)) inline bool tryReadFromISR(protectedType &out, int attempts = isrReadAttempts) const
+    {
+        for (int attempt = 0; attempt < attempts; attempt++)
+        {
+            if (readOnce(out))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Counts the completed writes, like LockableObject::generation(). Readable without any lock, also from an ISR.
+    uint32_t generation() const
+    {
+        return m_seq.load(std::memory_order_acquire) / 2;
+    }
+
+    // Returns a consistent copy. Spins briefly, then yields one tick at a time until the writer is done.
+    protectedType read() const
+    {
+        protectedType out;
+        for (int attempt = 1; !tryRead(out); attempt++)
+        {
+            if (attempt % readSpinCount == 0)
+            {
+                vTaskDelay(1);
+            }
+        }
+        return out;
+    }
+
+    // Returns a read access object with the default timeout duration (10ms).
+    ReadAccess getReadAccess() const
+    {
+        return getReadAccess(minBlockTime);
+    }
+
+    // Returns a read access object holding a consistent copy, or an invalid one if a writer kept the object busy until the timeout.
+    template <class Rep, class Period>
+    ReadAccess getReadAccess(const std::chrono::duration<Rep, Period> &timeout_duration) const
+    {
+        ReadAccess access;
+        const TickType_t start = xTaskGetTickCount();
+        const auto timeout_ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout_duration < minBlockTime ? minBlockTime : timeout_duration);
+        for (int attempt = 1; !(access.m_valid = tryRead(access.m_copy)); attempt++)
+        {
+            if (attempt % readSpinCount == 0)
+            {
+                if (std::chrono::milliseconds((xTaskGetTickCount() - start) * portTICK_PERIOD_MS) >= timeout_ms)
+                {
+                    break;
+                }
+                vTaskDelay(1);
+            }
+        }
+        return access;
+    }
+
+    // Returns a write access object with the default timeout duration (max).
+    WriteAccess getWriteAccess()
+    {
+        return WriteAccess(*this, maxBlockTime);
+    }
+
+    // Returns a write access object with the specified timeout duration. It will block until the timeout is reached.
+    template <class Rep, class Period>
+    WriteAccess getWriteAccess(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        auto actual_timeout = timeout_duration < minBlockTime ? minBlockTime : timeout_duration;
+        return WriteAccess(*this, actual_timeout);
+    }
+
+    // Replace the whole protected object in one short write section.
+    void write(const protectedType &value)
+    {
+        if (auto access = getWriteAccess())
+        {
+            m_protected = value;
+        }
+    }
+
+    // Clear the protected object, effectively resetting it.
+    void reset(void)
+    {
+        write(protectedType{});
+    }
+
+private:
+    __attribute__((always_inline)) inline bool readOnce(protectedType &out) const
+    {
+        const uint32_t seq = m_seq.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            return false;
+        }
+        std::memcpy(&out, &m_protected, sizeof(protectedType)); // memcpy is in ROM/IRAM, fine with the flash cache disabled
+        std::atomic_thread_fence(std::memory_order_acquire); // the copy must complete before re-checking the counter
+        return seq == m_seq.load(std::memory_order_relaxed);
+    }
+
+    void beginWrite()
+    {
+        m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); // the odd counter must be visible before any modification
+    }
+
+    void endWrite()
+    {
+        m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+// Types that benefit from SeqLockableObject: trivially copyable, and small enough that copying beats locking.
+template <typename T>
+inline constexpr bool isSeqLockable = std::is_trivially_copyable<T>::value && (sizeof(T) <= 32);
+
+// Picks SeqLockableObject for small trivially copyable types, LockableObject otherwise.
+template <typename T>
+using AutoLockableObject = std::conditional_t<isSeqLockable<T>, SeqLockableObject<T>, LockableObject<T>>;
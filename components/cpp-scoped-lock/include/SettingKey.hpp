@@ -0,0 +1,103 @@
+/*
+ * SettingKey.hpp
+ *  Hashed setting keys for MyConfigDb.
+ *
+ *  SettingKey is a non-owning (name, hash) pair. Declared constexpr, the hash is computed at compile time:
+ *
+ *      constexpr SettingKey kBrightness{"brightness"};   // or: constexpr auto kBrightness = "brightness"_key;
+ *      if (auto dbAccess = MyConfigDbManager::getInstance().getReadAccess())
+ *      {
+ *          auto value = dbAccess->get(kBrightness); // no std::string built, integer compares until the final match
+ *      }
+ *
+ *  SettingName is the owning key stored in MyConfigDb::settings. It keeps the hash next to the string,
+ *  and the settings are ordered by (hash, name), so lookups compare integers and only compare strings
+ *  on a hash match. Its string takes the Values allocator (see ConfigAllocator.hpp), like the values.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "ConfigAllocator.hpp"
+
+// 32 bit FNV-1a. Tiny, constexpr, and good enough to keep collisions (which stay correct, just slower) rare.
+constexpr uint32_t settingHash(std::string_view name)
+{
+    uint32_t hash = 2166136261UL;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+struct SettingKey
+{
+    std::string_view name;
+    uint32_t hash;
+
+    constexpr SettingKey(std::string_view n) : name{n}, hash{settingHash(n)} {}
+    constexpr SettingKey(const char *n) : SettingKey(std::string_view(n)) {}
+    SettingKey(const std::string &n) : SettingKey(std::string_view(n)) {}
+};
+
+constexpr SettingKey operator""_key(const char *name, std::size_t len)
+{
+    return SettingKey(std::string_view(name, len));
+}
+
+class SettingName
+{
+public:
+    using allocator_type = ConfigString::allocator_type;
+
+    SettingName() : m_hash{settingHash({})} {}
+    SettingName(std::string_view name, const allocator_type &allocator = allocator_type{})
+        : m_hash{settingHash(name)}, m_name{name, allocator}
+    {
+    }
+    SettingName(const std::string &name) : SettingName(std::string_view(name)) {}
+    SettingName(const char *name) : SettingName(std::string_view(name)) {}
+    SettingName(const SettingKey &key, const allocator_type &allocator = allocator_type{})
+        : m_hash{key.hash}, m_name{key.name, allocator}
+    {
+    }
+
+    uint32_t hash() const { return m_hash; }
+    std::string_view str() const { return m_name; }
+    const char *c_str() const { return m_name.c_str(); }
+    std::size_t size() const { return m_name.size(); }
+    operator std::string_view() const { return m_name; }
+    SettingKey key() const { return SettingKey(std::string_view(m_name)); }
+
+    bool operator==(const SettingName &other) const { return m_hash == other.m_hash && m_name == other.m_name; }
+    bool operator!=(const SettingName &other) const { return !(*this == other); }
+
+    // (hash, name) ordering used by MyConfigDb::settings. Transparent, so SettingKey works as a lookup key.
+    struct Less
+    {
+        using is_transparent = void;
+        using probe_type = SettingKey; // other lookup key types (i.e. const char*) are converted (hashed) once per lookup
+
+        bool operator()(const SettingName &a, const SettingName &b) const
+        {
+            return a.m_hash != b.m_hash ? a.m_hash < b.m_hash : a.m_name < b.m_name;
+        }
+        bool operator()(const SettingName &a, const SettingKey &b) const
+        {
+            return a.m_hash != b.hash ? a.m_hash < b.hash : std::string_view(a.m_name) < b.name;
+        }
+        bool operator()(const SettingKey &a, const SettingName &b) const
+        {
+            return a.hash != b.m_hash ? a.hash < b.m_hash : a.name < std::string_view(b.m_name);
+        }
+    };
+
+private:
+    uint32_t m_hash;
+    ConfigString m_name; // names beyond the SSO limit come from the Values allocator, like the values
+};
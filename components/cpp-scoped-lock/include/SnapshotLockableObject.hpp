@@ -0,0 +1,175 @@
+/*
+ * SnapshotLockableObject.hpp
+ *  RCU-style (read-copy-update) variant of LockableObject for objects that are read constantly and changed rarely.
+ *
+ *  Readers get a reference-counted pointer to an immutable version of the object. They never wait for
+ *  a writer, and may keep the snapshot as long as they like without blocking anyone.
+ *  Writers are serialized by a mutex. getWriteAccess() hands out a private copy of the current version,
+ *  which is published atomically when the WriteAccess goes out of scope. Old versions are freed when
+ *  the last reader drops its snapshot.
+ *
+ *      if (auto dbAccess = MyConfigDbSnapshotManager::getInstance().getReadAccess()) // never blocks
+ *      {
+ *          auto it = dbAccess->settings.find("name");
+ *      }
+ *
+ *  Note: each write copies the whole object, so this only pays off when writes are rare.
+ */
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include "freertos/FreeRTOS.h"
+
+template <typename protectedType, typename writerMutexType = std::timed_mutex>
+class SnapshotLockableObject
+{
+public:
+    using mutex_type = writerMutexType; // serializes writers only, readers never touch it
+    using write_lock = std::unique_lock<mutex_type>;
+    using snapshot_type = std::shared_ptr<const protectedType>;
+
+    static constexpr auto minBlockTime = std::chrono::milliseconds(10);
+    static constexpr auto maxBlockTime = std::chrono::milliseconds(portMAX_DELAY); // see LockableObject::maxBlockTime
+
+private:
+    mutable mutex_type m_writerMutex{};
+#if __cpp_lib_atomic_shared_ptr
+    std::atomic<snapshot_type> m_current{std::make_shared<const protectedType>()};
+#else
+    snapshot_type m_current{std::make_shared<const protectedType>()}; // only accessed through std::atomic_load/store
+#endif
+    static inline SnapshotLockableObject *sm_instance{};
+
+public:
+    // Optional Set Static Instance (when used as a singleton)
+    static void setStaticInstance(SnapshotLockableObject *ptr)
+    {
+        sm_instance = ptr;
+    };
+    // Optional Get Static Instance (when used as a singleton)
+    static SnapshotLockableObject &getInstance()
+    {
+        assert(sm_instance); // Dependency must be provided before use!
+        return *sm_instance;
+    };
+
+    // Holds one immutable version of the protected object alive.
+    class ReadAccess
+    {
+    public:
+        explicit ReadAccess(snapshot_type snapshot) : m_snapshot{std::move(snapshot)} {}
+
+        const protectedType *operator->() const { return m_snapshot.get(); }
+        const protectedType &operator*() const { return *m_snapshot; }
+
+        // always true, a snapshot is always available. Keeps call sites identical to LockableObject.
+        explicit operator bool() const & { return bool(m_snapshot); }
+
+    private:
+        snapshot_type m_snapshot;
+    };
+
+    // A private copy of the current version, published when this goes out of scope.
+    class WriteAccess
+    {
+    public:
+        template <class Rep, class Period>
+        WriteAccess(SnapshotLockableObject &owner, const std::chrono::duration<Rep, Period> &timeout_duration)
+            : m_owner{owner},
+              m_lock{owner.m_writerMutex, timeout_duration}
+        {
+            if (m_lock.owns_lock())
+            {
+                // copy outside of any reader's way; readers keep using the current version meanwhile
+                m_copy = std::make_shared<protectedType>(*m_owner.load());
+            }
+        }
+
+        ~WriteAccess()
+        {
+            if (m_lock.owns_lock())
+            {
+                m_owner.publish(std::move(m_copy));
+            }
+        }
+
+        WriteAccess(const WriteAccess &) = delete;
+        WriteAccess &operator=(const WriteAccess &) = delete;
+
+        // only allow access to the pointer with -> operator to prevent copying the protected object
+        protectedType *operator->() const { return m_copy.get(); }
+
+        // returns whether the exclusive lock is still active
+        explicit operator bool() const & { return m_lock.owns_lock(); }
+
+    private:
+        SnapshotLockableObject &m_owner;
+        write_lock m_lock;
+        std::shared_ptr<protectedType> m_copy{};
+    };
+
+    // Returns a cheap, reference-counted pointer to the current immutable version.
+    snapshot_type getSnapshot() const
+    {
+        return load();
+    }
+
+    // Returns a read access object holding the current version. Never blocks.
+    ReadAccess getReadAccess() const
+    {
+        return ReadAccess(load());
+    }
+
+    // Same as getReadAccess(), the timeout is only accepted for call site compatibility with LockableObject.
+    template <class Rep, class Period>
+    ReadAccess getReadAccess(const std::chrono::duration<Rep, Period> &) const
+    {
+        return ReadAccess(load());
+    }
+
+    // Returns a write access object with the default timeout duration (max).
+    WriteAccess getWriteAccess()
+    {
+        return WriteAccess(*this, maxBlockTime);
+    }
+
+    // Returns a write access object with the specified timeout duration. It will block until the timeout is reached.
+    template <class Rep, class Period>
+    WriteAccess getWriteAccess(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        auto actual_timeout = timeout_duration < minBlockTime ? minBlockTime : timeout_duration;
+        return WriteAccess(*this, actual_timeout);
+    }
+
+    // Publish a fresh default-constructed version. Readers holding old snapshots keep them.
+    void reset(void)
+    {
+        auto fresh = std::make_shared<const protectedType>(); // allocated before taking the lock
+        write_lock lock{m_writerMutex};
+        publish(std::move(fresh));
+    }
+
+private:
+    snapshot_type load() const
+    {
+#if __cpp_lib_atomic_shared_ptr
+        return m_current.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&m_current, std::memory_order_acquire);
+#endif
+    }
+
+    void publish(snapshot_type next)
+    {
+#if __cpp_lib_atomic_shared_ptr
+        m_current.store(std::move(next), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&m_current, std::move(next), std::memory_order_release);
+#endif
+    }
+};
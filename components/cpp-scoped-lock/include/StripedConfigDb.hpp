@@ -0,0 +1,293 @@
+/*
+ * StripedConfigDb.hpp
+ *  MyConfigDb split into independently locked stripes, so a writer of one key doesn't block the readers of the others:
+ *
+ *      MyConfigDbStripedManager dbMan;                      // CONFIG_SCOPED_LOCK_CONFIG_DB_STRIPES stripes
+ *      dbMan.set("wifi.ssid", "home");                      // locks only the stripe of "wifi.ssid"
+ *      if (auto db = dbMan.getReadAccess("led.enabled"))    // in parallel with writes to other stripes
+ *      {
+ *          bool on = db->getBool("led.enabled").value_or(false);
+ *      }
+ *      if (auto all = dbMan.getAllReadAccess())             // whole-database operations lock every stripe
+ *      {
+ *          all.forEachSetting([](SettingKey key, std::string_view value) { ... });
+ *      }
+ *
+ *  A key lives in the stripe key.hash % stripeCount. Each stripe is a LockableObject<MyConfigDb>, so the per-key
+ *  accesses are the usual ReadAccess/WriteAccess of that stripe, only ever use them for keys of that stripe.
+ *  The all-stripe accesses lock the stripes in index order, and a per-key access only holds one stripe, so they
+ *  can't deadlock each other. Don't hold a ReadAccess/WriteAccess of a stripe while taking another one.
+ *  The revision of each stripe counts separately (revision(), changedAt() and forEachChangedSince() per stripe).
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "FreeRtosSharedMutex.hpp"
+#include "LockableObject.hpp"
+#include "MyConfigDb.hpp"
+#include "SettingKey.hpp"
+
+#ifdef CONFIG_SCOPED_LOCK_CONFIG_DB_STRIPES
+#define SCOPED_LOCK_CONFIG_DB_STRIPES CONFIG_SCOPED_LOCK_CONFIG_DB_STRIPES
+#else
+#define SCOPED_LOCK_CONFIG_DB_STRIPES 8
+#endif
+
+template <std::size_t stripeCount, typename mutexType = std::shared_timed_mutex>
+class StripedConfigDb
+{
+    static_assert(stripeCount > 0, "StripedConfigDb needs at least one stripe");
+
+public:
+    using stripe_type = LockableObject<MyConfigDb, mutexType>;
+    using ReadAccess = typename stripe_type::ReadAccess;
+    using WriteAccess = typename stripe_type::WriteAccess;
+    static constexpr std::size_t stripes = stripeCount;
+    static constexpr auto minBlockTime = stripe_type::minBlockTime;
+    static constexpr auto maxBlockTime = stripe_type::maxBlockTime;
+
+    static constexpr std::size_t stripeOf(SettingKey key) { return key.hash % stripeCount; }
+
+    stripe_type &stripe(std::size_t index) { return m_stripes[index]; }
+    stripe_type &stripe(SettingKey key) { return m_stripes[stripeOf(key)]; }
+
+    //-- one key: only its stripe is locked
+
+    // Read access to the stripe of `key`, with the default timeout (10ms) like LockableObject::getReadAccess()
+    [[nodiscard]] ReadAccess getReadAccess(SettingKey key) { return stripe(key).getReadAccess(); }
+    template <class Rep, class Period>
+    [[nodiscard]] ReadAccess getReadAccess(SettingKey key, const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return stripe(key).getReadAccess(timeout_duration);
+    }
+    [[nodiscard]] WriteAccess getWriteAccess(SettingKey key) { return stripe(key).getWriteAccess(); }
+    template <class Rep, class Period>
+    [[nodiscard]] WriteAccess getWriteAccess(SettingKey key, const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return stripe(key).getWriteAccess(timeout_duration);
+    }
+
+    // A copy of the value, as the view of MyConfigDb::get() is only valid while the lock is held.
+    // nullopt if the key is not set, or the stripe could not be locked within the default timeout.
+    std::optional<std::string> get(SettingKey key)
+    {
+        if (auto db = getReadAccess(key))
+        {
+            if (auto value = db->get(key))
+            {
+                return std::string(*value);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Returns false if the stripe could not be locked
+    bool set(SettingKey key, std::string_view value)
+    {
+        if (auto db = getWriteAccess(key))
+        {
+            db->set(key, value);
+            return true;
+        }
+        return false;
+    }
+
+    // Returns whether the key existed in `settings` (false if the stripe could not be locked)
+    bool erase(SettingKey key)
+    {
+        auto db = getWriteAccess(key);
+        return db && db->erase(key);
+    }
+
+    //-- all stripes, locked in index order
+
+    template <class access_type, class db_type>
+    class AllAccess
+    {
+    public:
+        template <class Rep, class Period>
+        AllAccess(StripedConfigDb &owner, const std::chrono::duration<Rep, Period> &timeout_duration)
+        {
+            // one deadline for all stripes
+            const TickType_t ticks = FreeRtosSharedMutex::toTicks(timeout_duration);
+            const TickType_t start = xTaskGetTickCount();
+            for (std::size_t i = 0; i < stripeCount; i++)
+            {
+                const TickType_t elapsed = xTaskGetTickCount() - start;
+                const auto remaining = ticks == portMAX_DELAY ? maxBlockTime
+                                       : elapsed < ticks      ? std::chrono::milliseconds(static_cast<int64_t>(ticks - elapsed) * portTICK_PERIOD_MS)
+                                                              : std::chrono::milliseconds(0);
+                m_access[i].emplace(owner.m_stripes[i], remaining);
+                if (!*m_access[i])
+                {
+                    release();
+                    return;
+                }
+            }
+            m_held = true;
+        }
+
+        ~AllAccess() { release(); }
+
+        AllAccess(const AllAccess &) = delete;
+        AllAccess &operator=(const AllAccess &) = delete;
+
+        // The database of stripe `index`
+        db_type *operator[](std::size_t index) const { return m_access[index]->operator->(); }
+        db_type *operator[](SettingKey key) const { return (*this)[stripeOf(key)]; }
+
+        // Like MyConfigDb::forEachSetting() over all stripes: the defaults (shared by all stripes) that no stripe
+        // overrides, then the settings of each stripe.
+        template <class F>
+        void forEachSetting(F &&fn) const
+        {
+            (*this)[std::size_t(0)]->defaults().forEach([this, &fn](std::string_view name, std::string_view value) {
+                const SettingKey key{name};
+                if (!(*this)[key]->settings.contains(key))
+                {
+                    fn(key, value);
+                }
+            });
+            for (std::size_t i = 0; i < stripeCount; i++)
+            {
+                for (const auto &entry : (*this)[i]->settings)
+                {
+                    fn(entry.first.key(), std::string_view(entry.second));
+                }
+            }
+        }
+
+        // Number of keys in the settings of all stripes (not counting the defaults)
+        std::size_t size() const
+        {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < stripeCount; i++)
+            {
+                n += (*this)[i]->settings.size();
+            }
+            return n;
+        }
+
+        // returns whether all stripes are locked
+        explicit operator bool() const & { return m_held; }
+
+    private:
+        // in reverse order of locking
+        void release()
+        {
+            for (std::size_t i = stripeCount; i-- > 0;)
+            {
+                m_access[i].reset();
+            }
+            m_held = false;
+        }
+
+        std::array<std::optional<access_type>, stripeCount> m_access{};
+        bool m_held{false};
+    };
+
+    using AllReadAccess = AllAccess<ReadAccess, const MyConfigDb>;
+    using AllWriteAccess = AllAccess<WriteAccess, MyConfigDb>;
+
+    // Read access to all stripes, with the default timeout (10ms) for all of them together
+    [[nodiscard]] AllReadAccess getAllReadAccess() { return AllReadAccess(*this, minBlockTime); }
+    template <class Rep, class Period>
+    [[nodiscard]] AllReadAccess getAllReadAccess(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return AllReadAccess(*this, timeout_duration);
+    }
+    [[nodiscard]] AllWriteAccess getAllWriteAccess() { return AllWriteAccess(*this, maxBlockTime); }
+    template <class Rep, class Period>
+    [[nodiscard]] AllWriteAccess getAllWriteAccess(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return AllWriteAccess(*this, timeout_duration);
+    }
+
+    // The same defaults for every stripe, see MyConfigDb::setDefaults(). Returns false (and changes nothing) if
+    // the stripes could not be locked.
+    bool setDefaults(const ConfigBlobView &defaults)
+    {
+        auto all = getAllWriteAccess();
+        if (!all)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < stripeCount; i++)
+        {
+            all[i]->setDefaults(defaults);
+        }
+        return true;
+    }
+
+    // Clear all stripes at once, like LockableObject::reset(): only swapped under the locks (MyConfigDb::swapContents(),
+    // so the defaults are kept and the revisions go on), the old contents are destroyed after they are released.
+    void reset()
+    {
+        std::array<MyConfigDb, stripeCount> old{};
+        if (auto all = getAllWriteAccess())
+        {
+            for (std::size_t i = 0; i < stripeCount; i++)
+            {
+                all[i]->swapContents(old[i]);
+            }
+        }
+    }
+
+    // MyConfigDb::clear() of every stripe together: keeps the capacity, and the keys count as erased
+    void clear()
+    {
+        if (auto all = getAllWriteAccess())
+        {
+            for (std::size_t i = 0; i < stripeCount; i++)
+            {
+                all[i]->clear();
+            }
+        }
+    }
+
+    // Wake the task after a write to any stripe, see LockableObject::subscribe(). Uses one slot of every stripe,
+    // returns false (and subscribes to none) if a stripe has no free slot.
+    bool subscribe(uint32_t bits, TaskHandle_t task = xTaskGetCurrentTaskHandle())
+    {
+        for (std::size_t i = 0; i < stripeCount; i++)
+        {
+            if (!m_stripes[i].subscribe(bits, task))
+            {
+                while (i-- > 0)
+                {
+                    m_stripes[i].unsubscribe(task);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unsubscribe(TaskHandle_t task = xTaskGetCurrentTaskHandle())
+    {
+        for (auto &s : m_stripes)
+        {
+            s.unsubscribe(task);
+        }
+    }
+
+private:
+    std::array<stripe_type, stripeCount> m_stripes{};
+};
+
+using MyConfigDbStripedManager = StripedConfigDb<SCOPED_LOCK_CONFIG_DB_STRIPES>;
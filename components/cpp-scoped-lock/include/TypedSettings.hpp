@@ -0,0 +1,291 @@
+/*
+ * TypedSettings.hpp
+ *  Schema-driven settings stored as binary values instead of strings:
+ *
+ *      enum class WifiMode { Off, Station, Ap };
+ *      inline constexpr const char *wifiModeNames[] = {"off", "station", "ap"};
+ *      inline constexpr SettingDef mySchema[] = {
+ *          intSetting("wifi.retries", 5, 0, 100),
+ *          floatSetting("sensor.gain", 1.5f),
+ *          boolSetting("led.enabled", true),
+ *          enumSetting("wifi.mode", WifiMode::Station, wifiModeNames),
+ *      };
+ *      using MySettings = TypedSettings<mySchema>;
+ *      constexpr auto wifiRetries = MySettings::key<int32_t>("wifi.retries"); // a compile error if not in the schema
+ *      constexpr auto wifiMode = MySettings::key<WifiMode>("wifi.mode");
+ *
+ *      LockableObject<MySettings> settings; // or SeqLockableObject: it is trivially copyable
+ *      if (auto s = settings.getReadAccess())
+ *      {
+ *          int32_t retries = s->get(wifiRetries); // an array access, nothing parsed
+ *      }
+ *
+ *  Every value is a 4 byte SettingValue in one std::array, defaults from the schema, so there is no heap
+ *  allocation at all. A key is the index into that array, resolved (and type checked) at compile time.
+ *  Strings only come in at import/export: importFrom()/exportTo() a MyConfigDb (i.e. to persist it with
+ *  ConfigDbStore or ship it as a ConfigBlob), setFromString()/toString() for consoles and the cloud.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "MyConfigDb.hpp"
+#include "SettingKey.hpp"
+
+enum class SettingType : uint8_t
+{
+    Int,
+    Float,
+    Bool,
+    Enum, // stored as its index into SettingDef::names
+};
+
+// The value of one setting. Which member is used follows from the SettingDef of the setting.
+union SettingValue
+{
+    int32_t i; // Int, Enum
+    float f;
+    bool b;
+
+    constexpr SettingValue() : i{0} {}
+    constexpr SettingValue(int32_t v) : i{v} {}
+    constexpr SettingValue(float v) : f{v} {}
+    constexpr SettingValue(bool v) : b{v} {}
+};
+static_assert(sizeof(SettingValue) == 4, "SettingValue should stay compact");
+
+struct SettingDef
+{
+    SettingKey key;
+    SettingType type;
+    SettingValue defaultValue;
+    int32_t min; // Int: the valid range. Enum: 0 .. number of names - 1
+    int32_t max;
+    const char *const *names; // Enum: the names of the values, used for import and export
+};
+
+constexpr SettingDef intSetting(std::string_view name, int32_t defaultValue,
+                                int32_t min = std::numeric_limits<int32_t>::min(), int32_t max = std::numeric_limits<int32_t>::max())
+{
+    return SettingDef{SettingKey(name), SettingType::Int, SettingValue(defaultValue), min, max, nullptr};
+}
+
+constexpr SettingDef floatSetting(std::string_view name, float defaultValue)
+{
+    return SettingDef{SettingKey(name), SettingType::Float, SettingValue(defaultValue), 0, 0, nullptr};
+}
+
+constexpr SettingDef boolSetting(std::string_view name, bool defaultValue)
+{
+    return SettingDef{SettingKey(name), SettingType::Bool, SettingValue(defaultValue), 0, 1, nullptr};
+}
+
+template <typename E, std::size_t count>
+constexpr SettingDef enumSetting(std::string_view name, E defaultValue, const char *const (&names)[count])
+{
+    static_assert(count > 0, "an enum setting needs names");
+    return SettingDef{SettingKey(name), SettingType::Enum, SettingValue(static_cast<int32_t>(defaultValue)), 0,
+                      static_cast<int32_t>(count - 1), names};
+}
+
+// String conversion of one value (typedSettings.cpp). Int, Float and Bool parse like MyConfigDb::getInt() and
+// friends, Enum takes a name (or its index). Returns false, and leaves `value` alone, if invalid or out of range.
+bool settingFromString(const SettingDef &def, std::string_view text, SettingValue &value);
+void settingToString(const SettingDef &def, SettingValue value, std::string &out);
+bool settingValueValid(const SettingDef &def, SettingValue value);
+bool settingValueEquals(const SettingDef &def, SettingValue a, SettingValue b);
+
+// Not constexpr: calling it in a constant expression (from key()) is a compile error
+[[noreturn]] inline void typedSettingNotInSchema()
+{
+    abort();
+}
+
+// `schema`: a constexpr (preferably inline, in a header) array of SettingDef
+template <const auto &schema>
+class TypedSettings
+{
+public:
+    static constexpr std::size_t count = std::extent<std::remove_reference_t<decltype(schema)>>::value;
+    static_assert(count > 0 && count <= UINT16_MAX, "schema size");
+
+    // Typed handle of one setting. Only valid for this schema.
+    template <typename T>
+    struct Key
+    {
+        uint16_t index;
+    };
+
+    template <typename T>
+    static constexpr bool typeMatches(SettingType type)
+    {
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            return type == SettingType::Bool;
+        }
+        else if constexpr (std::is_same<T, float>::value)
+        {
+            return type == SettingType::Float;
+        }
+        else if constexpr (std::is_same<T, int32_t>::value)
+        {
+            return type == SettingType::Int || type == SettingType::Enum;
+        }
+        else if constexpr (std::is_enum<T>::value)
+        {
+            return type == SettingType::Enum;
+        }
+        return false;
+    }
+
+    // Index of the setting, for the by-name functions below
+    static constexpr std::optional<std::size_t> indexOf(SettingKey key)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (schema[i].key.hash == key.hash && schema[i].key.name == key.name)
+            {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Resolve a setting by name at compile time (declare the result constexpr). An unknown name, or a T that
+    // does not fit the type of the setting (int32_t/enum for Enum), does not compile.
+    template <typename T>
+    static constexpr Key<T> key(std::string_view name)
+    {
+        const auto index = indexOf(SettingKey(name));
+        if (!index || !typeMatches<T>(schema[*index].type))
+        {
+            typedSettingNotInSchema();
+        }
+        return Key<T>{static_cast<uint16_t>(*index)};
+    }
+
+    static constexpr const SettingDef &definition(std::size_t index) { return schema[index]; }
+
+    template <typename T>
+    T get(Key<T> key) const
+    {
+        const SettingValue &v = m_values[key.index];
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            return v.b;
+        }
+        else if constexpr (std::is_same<T, float>::value)
+        {
+            return v.f;
+        }
+        else
+        {
+            return static_cast<T>(v.i);
+        }
+    }
+
+    // Returns false, and keeps the old value, if `value` is out of the range of the setting
+    template <typename T>
+    bool set(Key<T> key, T value)
+    {
+        SettingValue v;
+        if constexpr (std::is_same<T, bool>::value || std::is_same<T, float>::value)
+        {
+            v = SettingValue(value);
+        }
+        else
+        {
+            v = SettingValue(static_cast<int32_t>(value));
+        }
+        if (!settingValueValid(schema[key.index], v))
+        {
+            return false;
+        }
+        m_values[key.index] = v;
+        return true;
+    }
+
+    template <typename T>
+    bool isDefault(Key<T> key) const
+    {
+        return settingValueEquals(schema[key.index], m_values[key.index], schema[key.index].defaultValue);
+    }
+
+    void reset() { m_values = defaults(); }
+
+    //-- by name, with strings: for import and export only
+
+    // Returns false if the key is not in the schema or the text is not a valid value
+    bool setFromString(SettingKey key, std::string_view text)
+    {
+        const auto index = indexOf(key);
+        return index && settingFromString(schema[*index], text, m_values[*index]);
+    }
+
+    std::optional<std::string> toString(SettingKey key) const
+    {
+        const auto index = indexOf(key);
+        if (!index)
+        {
+            return std::nullopt;
+        }
+        std::string out;
+        settingToString(schema[*index], m_values[*index], out);
+        return out;
+    }
+
+    // Take the value of every setting of the schema that `db` has (and that parses). Returns how many.
+    std::size_t importFrom(const MyConfigDb &db)
+    {
+        std::size_t imported = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (auto text = db.get(schema[i].key))
+            {
+                imported += settingFromString(schema[i], *text, m_values[i]) ? 1 : 0;
+            }
+        }
+        return imported;
+    }
+
+    // set() the values that differ from their default in `db`, and erase() the others (so a ConfigDbStore only
+    // stores what was changed). Keys of `db` that are not in the schema are left alone.
+    void exportTo(MyConfigDb &db) const
+    {
+        std::string text;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (settingValueEquals(schema[i], m_values[i], schema[i].defaultValue))
+            {
+                db.erase(schema[i].key);
+                continue;
+            }
+            settingToString(schema[i], m_values[i], text);
+            if (db.get(schema[i].key) != std::string_view(text))
+            {
+                db.set(schema[i].key, text);
+            }
+        }
+    }
+
+private:
+    static constexpr std::array<SettingValue, count> defaults()
+    {
+        std::array<SettingValue, count> values{};
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values[i] = schema[i].defaultValue;
+        }
+        return values;
+    }
+
+    std::array<SettingValue, count> m_values = defaults();
+};
@@ -0,0 +1,138 @@
+/*
+ * UpgradableMutex.hpp
+ *  Mutex policy that adds an upgradable access kind to LockableObject:
+ *
+ *      using MyConfigDbUpgradableManager = LockableObject<MyConfigDb, UpgradableMutex<>>;
+ *
+ *      if (auto access = dbMan.getUpgradableAccess())
+ *      {
+ *          if (access->get("name") != wanted && access.upgrade())
+ *          {
+ *              access->set("name", wanted); // exclusive now, nobody wrote in between
+ *          }
+ *      }
+ *
+ *  Wraps a shared mutex (the inner mutex, any LockableObject policy) and adds an upgrade gate (a plain mutex):
+ *   - readers only take the inner mutex shared, so they keep sharing it with the upgradable holder.
+ *   - writers and the upgradable holder both take the gate first, so there is at most one of them at a time.
+ *   - upgrading releases the shared inner lock and takes it exclusive. Readers may come and go in between,
+ *     but no writer can, because the upgradable holder keeps the gate all along.
+ *  The price is one more mutex for every writer.
+ */
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+
+#include "FreeRtosSharedMutex.hpp"
+#include "LockableObject.hpp"
+
+template <typename innerMutexType = std::shared_timed_mutex, typename gateMutexType = std::timed_mutex>
+class UpgradableMutex
+{
+public:
+    using inner_type = innerMutexType;
+    using gate_type = gateMutexType;
+
+    //-- Exclusive (writer) side: gate, then inner mutex. Same interface as std::shared_timed_mutex, so std::unique_lock works.
+
+    void lock()
+    {
+        m_gate.lock();
+        m_inner.lock();
+    }
+
+    bool try_lock()
+    {
+        if (!m_gate.try_lock())
+        {
+            return false;
+        }
+        if (!m_inner.try_lock())
+        {
+            m_gate.unlock();
+            return false;
+        }
+        return true;
+    }
+
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        if (!lockFor(m_gate, timeout_duration))
+        {
+            return false;
+        }
+        if (!lockFor(m_inner, timeout_duration))
+        {
+            m_gate.unlock();
+            return false;
+        }
+        return true;
+    }
+
+    void unlock()
+    {
+        m_inner.unlock();
+        m_gate.unlock();
+    }
+
+    //-- Shared (reader) side goes straight to the inner mutex, see LockTraits<UpgradableMutex> below.
+
+    inner_type &inner() { return m_inner; }
+    gate_type &gate() { return m_gate; }
+
+    // try_lock_for() of the std:: mutexes overflows on huge durations (i.e. milliseconds::max()) and then gives up
+    // at once when the lock is busy. Block in lock() for "forever" instead.
+    template <class Lockable, class Rep, class Period>
+    static bool lockFor(Lockable &m, const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        if (FreeRtosSharedMutex::toTicks(timeout_duration) == portMAX_DELAY)
+        {
+            m.lock();
+            return true;
+        }
+        return m.try_lock_for(timeout_duration);
+    }
+
+private:
+    gate_type m_gate{};
+    inner_type m_inner{};
+};
+
+template <typename innerMutexType, typename gateMutexType>
+struct LockTraits<UpgradableMutex<innerMutexType, gateMutexType>>
+{
+    // the inner mutex's own read lock, constructed from the UpgradableMutex
+    class read_lock : public LockTraits<innerMutexType>::read_lock
+    {
+    public:
+        template <class Rep, class Period>
+        read_lock(UpgradableMutex<innerMutexType, gateMutexType> &m, const std::chrono::duration<Rep, Period> &timeout_duration)
+            : LockTraits<innerMutexType>::read_lock(m.inner(), timeout_duration)
+        {
+        }
+    };
+    using write_lock = std::unique_lock<UpgradableMutex<innerMutexType, gateMutexType>>;
+
+    using read_token = typename LockTraits<innerMutexType>::read_token;
+
+    template <class Rep, class Period>
+    static bool tryLock(UpgradableMutex<innerMutexType, gateMutexType> &m, const std::chrono::duration<Rep, Period> &timeout_duration)
+    {
+        return m.try_lock_for(timeout_duration);
+    }
+    static void unlock(UpgradableMutex<innerMutexType, gateMutexType> &m) { m.unlock(); }
+
+    template <class Rep, class Period>
+    static bool tryLockShared(UpgradableMutex<innerMutexType, gateMutexType> &m, const std::chrono::duration<Rep, Period> &timeout_duration,
+                              read_token &token)
+    {
+        return LockTraits<innerMutexType>::tryLockShared(m.inner(), timeout_duration, token);
+    }
+    static void unlockShared(UpgradableMutex<innerMutexType, gateMutexType> &m, read_token &token)
+    {
+        LockTraits<innerMutexType>::unlockShared(m.inner(), token);
+    }
+};
@@ -0,0 +1,180 @@
+/*
+ * configAllocator.cpp
+ *  The memory of MyConfigDb, see ConfigAllocator.hpp.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "ConfigAllocator.hpp"
+
+namespace
+{
+    class NewDeleteAllocator : public ConfigAllocator
+    {
+    public:
+        void *allocate(std::size_t size) override { return ::operator new(size); }
+        void deallocate(void *p, std::size_t) override { ::operator delete(p); }
+    };
+
+    std::atomic<ConfigAllocator *> s_index{nullptr};
+    std::atomic<ConfigAllocator *> s_values{nullptr};
+
+    std::size_t roundUp(std::size_t size)
+    {
+        constexpr std::size_t align = alignof(std::max_align_t);
+        return (size + align - 1) / align * align;
+    }
+
+    // portENTER_CRITICAL() as a scope
+    class CriticalSection
+    {
+    public:
+        explicit CriticalSection(portMUX_TYPE &mux) : m_mux{mux} { portENTER_CRITICAL(&m_mux); }
+        ~CriticalSection() { portEXIT_CRITICAL(&m_mux); }
+        CriticalSection(const CriticalSection &) = delete;
+        CriticalSection &operator=(const CriticalSection &) = delete;
+
+    private:
+        portMUX_TYPE &m_mux;
+    };
+} // namespace
+
+void ConfigAllocator::use(ConfigAllocator *index, ConfigAllocator *values)
+{
+    s_index.store(index, std::memory_order_release);
+    s_values.store(values, std::memory_order_release);
+}
+
+ConfigAllocator *ConfigAllocator::current(Role role)
+{
+    ConfigAllocator *a = (role == Role::Index ? s_index : s_values).load(std::memory_order_acquire);
+    return a ? a : &heap();
+}
+
+ConfigAllocator &ConfigAllocator::heap()
+{
+    // leaked on purpose: MyConfigDbs in static storage of other translation units may be destroyed after it
+    static ConfigAllocator *const s_heap = new NewDeleteAllocator{};
+    return *s_heap;
+}
+
+//-- ConfigPoolAllocator
+
+ConfigPoolAllocator::ConfigPoolAllocator(std::size_t blockSize, std::size_t blockCount, uint32_t caps)
+    : m_blockSize{roundUp(blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize)},
+      m_blockCount{blockCount},
+      m_caps{caps}
+{
+    if (blockCount == 0)
+    {
+        return;
+    }
+    m_begin = static_cast<uint8_t *>(heapCapsAllocate(m_blockSize * blockCount, caps));
+    m_end = m_begin + m_blockSize * blockCount;
+    // in address order, so the first allocations are adjacent
+    for (std::size_t i = blockCount; i-- > 0;)
+    {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>(m_begin + i * m_blockSize);
+        block->next = m_free;
+        m_free = block;
+    }
+    m_freeCount = blockCount;
+}
+
+ConfigPoolAllocator::~ConfigPoolAllocator()
+{
+    heap_caps_free(m_begin);
+}
+
+void *ConfigPoolAllocator::allocate(std::size_t size)
+{
+    if (size <= m_blockSize)
+    {
+        CriticalSection lock{m_mux};
+        if (FreeBlock *block = m_free)
+        {
+            m_free = block->next;
+            m_freeCount--;
+            return block;
+        }
+    }
+    m_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    return heapCapsAllocate(size, m_caps);
+}
+
+void ConfigPoolAllocator::deallocate(void *p, std::size_t)
+{
+    if (!owns(p))
+    {
+        heap_caps_free(p);
+        return;
+    }
+    CriticalSection lock{m_mux};
+    FreeBlock *block = static_cast<FreeBlock *>(p);
+    block->next = m_free;
+    m_free = block;
+    m_freeCount++;
+}
+
+std::size_t ConfigPoolAllocator::blocksUsed() const
+{
+    CriticalSection lock{m_mux};
+    return m_blockCount - m_freeCount;
+}
+
+//-- ConfigArenaAllocator
+
+ConfigArenaAllocator::ConfigArenaAllocator(std::size_t size, uint32_t caps) : m_caps{caps}
+{
+    size = roundUp(size);
+    if (size == 0)
+    {
+        return;
+    }
+    m_begin = static_cast<uint8_t *>(heapCapsAllocate(size, caps));
+    m_end = m_begin + size;
+    m_next = m_begin;
+}
+
+ConfigArenaAllocator::~ConfigArenaAllocator()
+{
+    heap_caps_free(m_begin);
+}
+
+void *ConfigArenaAllocator::allocate(std::size_t size)
+{
+    const std::size_t rounded = roundUp(size == 0 ? 1 : size);
+    {
+        CriticalSection lock{m_mux};
+        if (rounded <= std::size_t(m_end - m_next))
+        {
+            void *p = m_next;
+            m_next += rounded;
+            m_live++;
+            return p;
+        }
+    }
+    m_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    return heapCapsAllocate(size, m_caps);
+}
+
+void ConfigArenaAllocator::deallocate(void *p, std::size_t)
+{
+    if (!owns(p))
+    {
+        heap_caps_free(p);
+        return;
+    }
+    CriticalSection lock{m_mux};
+    if (--m_live == 0)
+    {
+        m_next = m_begin; // all freed, start over
+    }
+}
+
+std::size_t ConfigArenaAllocator::used() const
+{
+    CriticalSection lock{m_mux};
+    return std::size_t(m_next - m_begin);
+}
@@ -0,0 +1,406 @@
+/*
+ * configBlob.cpp
+ *  Binary serialization of MyConfigDb, see ConfigBlob.hpp.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ConfigBlob.hpp"
+#include "MyConfigDb.hpp"
+
+namespace
+{
+    uint32_t getU32(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+
+    uint16_t getU16(const uint8_t *p)
+    {
+        return uint16_t(p[0] | p[1] << 8);
+    }
+
+    void putU32(uint8_t *p, uint32_t v)
+    {
+        p[0] = uint8_t(v);
+        p[1] = uint8_t(v >> 8);
+        p[2] = uint8_t(v >> 16);
+        p[3] = uint8_t(v >> 24);
+    }
+
+    void appendU32(std::vector<uint8_t> &out, uint32_t v)
+    {
+        const std::size_t at = out.size();
+        out.resize(at + 4);
+        putU32(&out[at], v);
+    }
+
+    std::size_t varintSize(uint32_t v)
+    {
+        std::size_t n = 1;
+        for (; v >= 0x80; v >>= 7)
+        {
+            n++;
+        }
+        return n;
+    }
+
+    void appendVarint(std::vector<uint8_t> &out, uint32_t v)
+    {
+        for (; v >= 0x80; v >>= 7)
+        {
+            out.push_back(uint8_t(v | 0x80));
+        }
+        out.push_back(uint8_t(v));
+    }
+
+    void appendBytes(std::vector<uint8_t> &out, std::string_view s)
+    {
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    // Bounds checked varint read. Returns nullptr if it does not fit before `end` or overflows 32 bits.
+    const uint8_t *readVarint(const uint8_t *p, const uint8_t *end, uint32_t &v)
+    {
+        v = 0;
+        for (unsigned shift = 0; shift < 35 && p < end; shift += 7)
+        {
+            const uint8_t b = *p++;
+            if (shift == 28 && (b & 0xf0))
+            {
+                return nullptr;
+            }
+            v |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    // Unchecked version, for data the ConfigBlobView constructor has validated
+    const uint8_t *readVarint(const uint8_t *p, uint32_t &v)
+    {
+        v = 0;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            const uint8_t b = *p++;
+            v |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                return p;
+            }
+        }
+    }
+
+    // Bounds checked string (varint length + bytes).
+    const uint8_t *skipString(const uint8_t *p, const uint8_t *end)
+    {
+        uint32_t length = 0;
+        p = readVarint(p, end, length);
+        return (p && length <= std::size_t(end - p)) ? p + length : nullptr;
+    }
+
+    std::string_view asView(const uint8_t *p, std::size_t length)
+    {
+        return std::string_view(reinterpret_cast<const char *>(p), length);
+    }
+
+    // Values that take less space in the dictionary, sorted (that order gives the index)
+    std::vector<std::string_view> buildDictionary(const MyConfigDb::settings_type &settings)
+    {
+        std::vector<std::string_view> values;
+        values.reserve(settings.size());
+        for (const auto &entry : settings)
+        {
+            if (entry.second.size() >= 2)
+            {
+                values.emplace_back(entry.second);
+            }
+        }
+        std::sort(values.begin(), values.end());
+
+        std::vector<std::string_view> dictionary;
+        for (auto it = values.begin(); it != values.end();)
+        {
+            const auto next = std::upper_bound(it, values.end(), *it);
+            const std::size_t uses = next - it;
+            const std::size_t length = it->size();
+            const std::size_t inlineCost = uses * (varintSize(uint32_t(length) << 1) + length);
+            // offset, string, and a reference of (most likely) one byte per use, two with more than 63 entries
+            const std::size_t dictionaryCost = 4 + varintSize(uint32_t(length)) + length + uses * (dictionary.size() < 63 ? 1 : 2);
+            if (uses > 1 && dictionaryCost < inlineCost)
+            {
+                dictionary.push_back(*it);
+            }
+            it = next;
+        }
+        return dictionary;
+    }
+} // namespace
+
+void MyConfigDb::serialize(std::vector<uint8_t> &out, bool dictionary, bool index) const
+{
+    const std::size_t start = out.size();
+    const std::vector<std::string_view> dict = dictionary ? buildDictionary(settings) : std::vector<std::string_view>{};
+    std::size_t estimate = ConfigBlob::headerSize + 8 + 4 * dict.size();
+    for (const auto &entry : settings)
+    {
+        estimate += 2 + entry.first.size() + 2 + entry.second.size() + (index ? 8 : 0);
+    }
+    std::vector<uint32_t> entryOffsets;
+    if (index)
+    {
+        entryOffsets.reserve(settings.size());
+    }
+    out.reserve(start + estimate);
+    out.resize(start + ConfigBlob::headerSize);
+
+    if (!dict.empty())
+    {
+        appendU32(out, uint32_t(dict.size()));
+        const std::size_t entriesOffsetAt = out.size();
+        appendU32(out, 0);
+        const std::size_t tableAt = out.size();
+        out.resize(tableAt + 4 * dict.size());
+        for (std::size_t i = 0; i < dict.size(); i++)
+        {
+            putU32(&out[tableAt + 4 * i], uint32_t(out.size() - start));
+            appendVarint(out, uint32_t(dict[i].size()));
+            appendBytes(out, dict[i]);
+        }
+        putU32(&out[entriesOffsetAt], uint32_t(out.size() - start));
+    }
+
+    for (const auto &entry : settings)
+    {
+        if (index)
+        {
+            entryOffsets.push_back(uint32_t(out.size() - start));
+        }
+        appendVarint(out, uint32_t(entry.first.size()));
+        appendBytes(out, entry.first.str());
+        const std::string_view value(entry.second);
+        const auto found = std::lower_bound(dict.begin(), dict.end(), value);
+        if (found != dict.end() && *found == value)
+        {
+            appendVarint(out, uint32_t(found - dict.begin()) << 1 | 1);
+        }
+        else
+        {
+            appendVarint(out, uint32_t(value.size()) << 1);
+            appendBytes(out, value);
+        }
+    }
+
+    if (index)
+    {
+        auto offset = entryOffsets.begin();
+        for (const auto &entry : settings)
+        {
+            appendU32(out, entry.first.hash());
+            appendU32(out, *offset++);
+        }
+    }
+
+    uint8_t *header = &out[start];
+    const uint32_t size = uint32_t(out.size() - start);
+    putU32(header, ConfigBlob::magic);
+    header[4] = uint8_t(ConfigBlob::version);
+    header[5] = uint8_t(ConfigBlob::version >> 8);
+    header[6] = uint8_t((dict.empty() ? 0 : ConfigBlob::hasDictionary) | (index ? ConfigBlob::hasIndex : 0));
+    header[7] = 0;
+    putU32(header + 8, uint32_t(settings.size()));
+    putU32(header + 12, size);
+    putU32(header + 16, settingHash(asView(header + ConfigBlob::headerSize, size - ConfigBlob::headerSize)));
+}
+
+bool MyConfigDb::load(const ConfigBlobView &blob)
+{
+    if (!blob.valid())
+    {
+        return false;
+    }
+    // in settings order, so every new key is appended at the end of an empty database
+    settings.reserve(settings.size() + blob.count());
+    blob.forEach([this](std::string_view name, std::string_view value) { set(name, value); });
+    return true;
+}
+
+ConfigBlobView::ConfigBlobView(const void *data, std::size_t size) : m_data{static_cast<const uint8_t *>(data)}
+{
+    if (!m_data || size < ConfigBlob::headerSize || getU32(m_data) != ConfigBlob::magic ||
+        getU16(m_data + 4) != ConfigBlob::version)
+    {
+        return;
+    }
+    const uint16_t flags = getU16(m_data + 6);
+    const uint32_t count = getU32(m_data + 8);
+    const uint32_t total = getU32(m_data + 12);
+    if (total < ConfigBlob::headerSize || total > size ||
+        getU32(m_data + 16) != settingHash(asView(m_data + ConfigBlob::headerSize, total - ConfigBlob::headerSize)))
+    {
+        return;
+    }
+    const uint8_t *const end = m_data + total;
+    const uint8_t *p = m_data + ConfigBlob::headerSize;
+
+    uint32_t dictionaryCount = 0;
+    const uint8_t *dictionary = nullptr;
+    if (flags & ConfigBlob::hasDictionary)
+    {
+        if (end - p < 8)
+        {
+            return;
+        }
+        dictionaryCount = getU32(p);
+        const uint32_t entriesOffset = getU32(p + 4);
+        dictionary = p + 8;
+        if (dictionaryCount > std::size_t(end - dictionary) / 4 || entriesOffset > total ||
+            entriesOffset < std::size_t(dictionary - m_data) + 4 * std::size_t(dictionaryCount))
+        {
+            return;
+        }
+        for (uint32_t i = 0; i < dictionaryCount; i++)
+        {
+            const uint32_t offset = getU32(dictionary + 4 * i);
+            if (offset >= total || !skipString(m_data + offset, end))
+            {
+                return;
+            }
+        }
+        p = m_data + entriesOffset;
+    }
+
+    const uint8_t *const entries = p;
+    const uint8_t *index = nullptr;
+    const uint8_t *entriesEnd = end;
+    if (flags & ConfigBlob::hasIndex)
+    {
+        if (count > std::size_t(end - entries) / 8)
+        {
+            return;
+        }
+        entriesEnd = end - 8 * std::size_t(count);
+        index = entriesEnd;
+    }
+    uint32_t previousHash = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t *const entry = p;
+        uint32_t value = 0;
+        p = skipString(p, entriesEnd);
+        p = p ? readVarint(p, entriesEnd, value) : nullptr;
+        if (!p)
+        {
+            return;
+        }
+        if (value & 1)
+        {
+            if ((value >> 1) >= dictionaryCount)
+            {
+                return;
+            }
+        }
+        else if ((value >> 1) > std::size_t(entriesEnd - p))
+        {
+            return;
+        }
+        else
+        {
+            p += value >> 1;
+        }
+        if (index)
+        {
+            // must match the entry, and be sorted for the binary search
+            uint32_t length = 0;
+            const uint8_t *name = readVarint(entry, length);
+            const uint32_t hash = getU32(index + 8 * i);
+            if (hash != settingHash(asView(name, length)) || getU32(index + 8 * i + 4) != uint32_t(entry - m_data) ||
+                hash < previousHash)
+            {
+                return;
+            }
+            previousHash = hash;
+        }
+    }
+    if (p != entriesEnd)
+    {
+        return;
+    }
+
+    m_index = index;
+    m_dictionary = dictionary;
+    m_dictionaryCount = dictionaryCount;
+    m_count = count;
+    m_size = total;
+    m_entries = entries; // valid() from here on
+}
+
+std::string_view ConfigBlobView::dictionaryString(uint32_t index) const
+{
+    uint32_t length = 0;
+    const uint8_t *p = readVarint(m_data + getU32(m_dictionary + 4 * index), length);
+    return asView(p, length);
+}
+
+const uint8_t *ConfigBlobView::readEntry(const uint8_t *p, std::string_view &name, std::string_view &value) const
+{
+    uint32_t n = 0;
+    p = readVarint(p, n);
+    name = asView(p, n);
+    p = readVarint(p + n, n);
+    if (n & 1)
+    {
+        value = dictionaryString(n >> 1);
+        return p;
+    }
+    value = asView(p, n >> 1);
+    return p + (n >> 1);
+}
+
+std::optional<std::string_view> ConfigBlobView::find(SettingKey key) const
+{
+    if (m_index)
+    {
+        // binary search for the first entry with the hash, then compare the names of all with that hash
+        uint32_t first = 0, n = m_count;
+        while (n > 0)
+        {
+            const uint32_t half = n / 2;
+            if (getU32(m_index + 8 * (first + half)) < key.hash)
+            {
+                first += half + 1;
+                n -= half + 1;
+            }
+            else
+            {
+                n = half;
+            }
+        }
+        for (uint32_t i = first; i < m_count && getU32(m_index + 8 * i) == key.hash; i++)
+        {
+            std::string_view name, value;
+            readEntry(m_data + getU32(m_index + 8 * i + 4), name, value);
+            if (name == key.name)
+            {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+    const uint8_t *p = m_entries;
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        std::string_view name, value;
+        p = readEntry(p, name, value);
+        if (name == key.name)
+        {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
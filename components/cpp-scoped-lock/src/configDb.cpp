@@ -10,5 +10,225 @@
 #include "esp_log.h"
 #include "MyConfigDb.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
 constexpr auto *TAG = "cDb";
 
+
+std::optional<std::string_view> MyConfigDb::get(SettingKey key) const
+{
+    auto it = settings.find(key);
+    if (it == settings.end())
+    {
+        return m_defaults.find(key);
+    }
+    return std::string_view(it->second);
+}
+
+bool MyConfigDb::contains(SettingKey key) const
+{
+    return settings.contains(key) || m_defaults.find(key);
+}
+
+std::optional<int32_t> MyConfigDb::getInt(SettingKey key) const
+{
+    auto value = get(key);
+    return value ? parseInt(*value) : std::nullopt;
+}
+
+std::optional<int32_t> MyConfigDb::parseInt(std::string_view text)
+{
+    if (text.empty())
+    {
+        return std::nullopt;
+    }
+    const char *first = text.data();
+    const char *last = first + text.size();
+    int base = 10;
+    bool negative = false;
+    if (*first == '+' || *first == '-')
+    {
+        negative = (*first == '-');
+        first++;
+    }
+    if ((last - first) > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+    {
+        base = 16;
+        first += 2;
+    }
+    // parse as unsigned, then apply the sign, so that INT32_MIN works and "--1" is rejected
+    uint32_t magnitude = 0;
+    auto result = std::from_chars(first, last, magnitude, base);
+    if (result.ec != std::errc() || result.ptr != last || first == last)
+    {
+        return std::nullopt;
+    }
+    if (negative)
+    {
+        if (magnitude > static_cast<uint32_t>(INT32_MAX) + 1U)
+        {
+            return std::nullopt;
+        }
+        return static_cast<int32_t>(0U - magnitude);
+    }
+    if (magnitude > static_cast<uint32_t>(INT32_MAX))
+    {
+        return std::nullopt;
+    }
+    return static_cast<int32_t>(magnitude);
+}
+
+static bool equalsIgnoreCase(std::string_view a, const char *b)
+{
+    const size_t len = strlen(b);
+    if (a.size() != len)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (tolower(static_cast<unsigned char>(a[i])) != b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<bool> MyConfigDb::getBool(SettingKey key) const
+{
+    auto value = get(key);
+    return value ? parseBool(*value) : std::nullopt;
+}
+
+std::optional<bool> MyConfigDb::parseBool(std::string_view text)
+{
+    for (const char *t : {"1", "true", "on", "yes"})
+    {
+        if (equalsIgnoreCase(text, t))
+        {
+            return true;
+        }
+    }
+    for (const char *f : {"0", "false", "off", "no"})
+    {
+        if (equalsIgnoreCase(text, f))
+        {
+            return false;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<float> MyConfigDb::getFloat(SettingKey key) const
+{
+    auto value = get(key);
+    return value ? parseFloat(*value) : std::nullopt;
+}
+
+std::optional<float> MyConfigDb::parseFloat(std::string_view text)
+{
+    // strtof needs a terminated string; copy to the stack instead of building a std::string
+    char buf[32];
+    if (text.empty() || text.size() >= sizeof(buf))
+    {
+        return std::nullopt;
+    }
+    memcpy(buf, text.data(), text.size());
+    buf[text.size()] = '\0';
+    char *end = nullptr;
+    const float f = strtof(buf, &end);
+    if (end != buf + text.size())
+    {
+        return std::nullopt;
+    }
+    return f;
+}
+
+void MyConfigDb::set(SettingKey key, std::string_view value)
+{
+    if (m_defaults.valid() && m_defaults.find(key) == value)
+    {
+        settings.erase(key); // back to the default, keep the overlay small
+        stamp(key);
+        return;
+    }
+    auto it = settings.lower_bound(key);
+    if (it != settings.end() && !settings.key_comp()(key, it->first))
+    {
+        it->second.assign(value.data(), value.size());
+    }
+    else
+    {
+        settings.try_emplace(makeName(key), makeValue(value));
+    }
+    stamp(key);
+}
+
+bool MyConfigDb::erase(SettingKey key)
+{
+    if (settings.erase(key) == 0)
+    {
+        return false;
+    }
+    stamp(key);
+    return true;
+}
+
+void MyConfigDb::clear()
+{
+    for (const auto &entry : settings)
+    {
+        stamp(entry.first.key()); // tracked like erase(), so i.e. ConfigDbStore erases them from flash
+    }
+    settings.clear();
+}
+
+void MyConfigDb::swapContents(MyConfigDb &other)
+{
+    settings.swap(other.settings);
+    std::swap(m_valueAllocator, other.m_valueAllocator);
+    for (const auto &entry : other.settings)
+    {
+        stamp(entry.first.key()); // erased, unless the new settings have it too
+    }
+    for (const auto &entry : settings)
+    {
+        stamp(entry.first.key());
+    }
+}
+
+uint32_t MyConfigDb::changedAt(SettingKey key) const
+{
+    auto it = m_changes.find(key);
+    return it == m_changes.end() ? 0 : it->second;
+}
+
+void MyConfigDb::forgetChangesUpTo(uint32_t upTo)
+{
+    upTo = std::min(upTo, m_revision);
+    if (upTo <= m_forgottenUpTo)
+    {
+        return;
+    }
+    erase_if(m_changes, [upTo](const auto &change) { return change.second <= upTo; });
+    m_forgottenUpTo = upTo;
+}
+
+void MyConfigDb::stamp(SettingKey key)
+{
+    m_revision++;
+    auto it = m_changes.lower_bound(key);
+    if (it != m_changes.end() && !m_changes.key_comp()(key, it->first))
+    {
+        it->second = m_revision;
+    }
+    else
+    {
+        m_changes.try_emplace(makeName(key), m_revision);
+    }
+}
@@ -0,0 +1,531 @@
+/*
+ * configDbStore.cpp
+ *  NVS load and write-behind of MyConfigDbManager, see ConfigDbStore.hpp.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_idf_version.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "ConfigDbStore.hpp"
+
+constexpr auto *TAG = "cDbStore";
+
+namespace
+{
+    constexpr uint32_t changedBit = 1U << 0;
+    constexpr uint32_t stopBit = 1U << 1;
+
+    class IoLock
+    {
+    public:
+        explicit IoLock(SemaphoreHandle_t mutex) : m_mutex{mutex} { xSemaphoreTake(m_mutex, portMAX_DELAY); }
+        ~IoLock() { xSemaphoreGive(m_mutex); }
+        IoLock(const IoLock &) = delete;
+        IoLock &operator=(const IoLock &) = delete;
+
+    private:
+        SemaphoreHandle_t m_mutex;
+    };
+
+    // Names with the same hash take the probe keys "<hash>.1", "<hash>.2", ... after "<hash>", without gaps
+    constexpr uint8_t maxProbes = 8;
+    static_assert(maxProbes <= 10 && sizeof("01234567.1") <= NVS_KEY_NAME_MAX_SIZE, "one digit after the hash");
+
+    struct NvsKey
+    {
+        explicit NvsKey(uint32_t hash, uint8_t probe = 0)
+        {
+            assert(probe < maxProbes);
+            snprintf(str, sizeof(str), "%08" PRIx32, hash);
+            if (probe != 0)
+            {
+                str[8] = '.';
+                str[9] = static_cast<char>('0' + probe);
+                str[10] = '\0';
+            }
+        }
+        char str[NVS_KEY_NAME_MAX_SIZE];
+    };
+
+    // Split a stored "name\0value" blob. Returns false if it is not one.
+    bool splitBlob(const std::string &blob, std::string_view &name, std::string_view &value)
+    {
+        const auto nul = blob.find('\0');
+        if (nul == std::string::npos)
+        {
+            return false;
+        }
+        name = std::string_view(blob).substr(0, nul);
+        value = std::string_view(blob).substr(nul + 1);
+        return true;
+    }
+
+    bool getBlob(nvs_handle_t handle, const char *key, std::string &blob)
+    {
+        size_t length = 0;
+        if (ESP_OK != nvs_get_blob(handle, key, nullptr, &length))
+        {
+            return false;
+        }
+        blob.resize(length);
+        return ESP_OK == nvs_get_blob(handle, key, &blob[0], &length) && length == blob.size();
+    }
+
+    struct NvsProbe
+    {
+        uint8_t probe; // of the name if found, else the end of the chain (maxProbes if it is full)
+        bool found;
+    };
+
+    // Look `name` up in the probe chain of its hash. blob is the stored "name\0value" of a found name.
+    NvsProbe findProbe(nvs_handle_t handle, std::string_view name, uint32_t hash, std::string &blob)
+    {
+        uint8_t probe = 0;
+        for (; probe < maxProbes && getBlob(handle, NvsKey(hash, probe).str, blob); probe++)
+        {
+            std::string_view stored, value;
+            if (splitBlob(blob, stored, value) && stored == name)
+            {
+                return {probe, true};
+            }
+        }
+        return {probe, false};
+    }
+
+    esp_err_t setName(nvs_handle_t handle, std::string_view name, uint32_t hash, std::string_view value)
+    {
+        std::string blob;
+        const NvsProbe slot = findProbe(handle, name, hash, blob);
+        if (slot.probe == maxProbes)
+        {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE; // too many names with this hash
+        }
+        blob.assign(name).push_back('\0');
+        blob.append(value);
+        return nvs_set_blob(handle, NvsKey(hash, slot.probe).str, blob.data(), blob.size());
+    }
+
+    // Only erases the entry of `name`, and moves the last one of the chain into its place
+    esp_err_t eraseName(nvs_handle_t handle, std::string_view name, uint32_t hash)
+    {
+        std::string blob;
+        const NvsProbe slot = findProbe(handle, name, hash, blob);
+        if (!slot.found)
+        {
+            return ESP_OK;
+        }
+        uint8_t last = slot.probe;
+        for (std::string next; last + 1 < maxProbes && getBlob(handle, NvsKey(hash, uint8_t(last + 1)).str, next); last++)
+        {
+            blob.swap(next);
+        }
+        if (last != slot.probe)
+        {
+            const esp_err_t err = nvs_set_blob(handle, NvsKey(hash, slot.probe).str, blob.data(), blob.size());
+            if (err != ESP_OK)
+            {
+                return err;
+            }
+        }
+        return nvs_erase_key(handle, NvsKey(hash, last).str);
+    }
+
+    std::optional<std::string> copyOf(std::optional<std::string_view> value)
+    {
+        return value ? std::optional<std::string>(std::in_place, *value) : std::nullopt;
+    }
+
+    // Calls fn(key) for all blobs of the namespace. Returns false if it can't be iterated.
+    template <class F>
+    bool forEachBlobKey(const char *nvsNamespace, F &&fn)
+    {
+        nvs_entry_info_t info;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        nvs_iterator_t it = nullptr;
+        esp_err_t err = nvs_entry_find(NVS_DEFAULT_PART_NAME, nvsNamespace, NVS_TYPE_BLOB, &it);
+        while (err == ESP_OK)
+        {
+            nvs_entry_info(it, &info);
+            fn(info.key);
+            err = nvs_entry_next(&it);
+        }
+        nvs_release_iterator(it);
+        return err == ESP_ERR_NVS_NOT_FOUND; // the end of the iteration
+#else
+        for (nvs_iterator_t it = nvs_entry_find(NVS_DEFAULT_PART_NAME, nvsNamespace, NVS_TYPE_BLOB); it;
+             it = nvs_entry_next(it))
+        {
+            nvs_entry_info(it, &info);
+            fn(info.key);
+        }
+        return true;
+#endif
+    }
+} // namespace
+
+ConfigDbStore::ConfigDbStore(MyConfigDbManager &db, const char *nvsNamespace)
+    : m_db{db}, m_namespace{nvsNamespace}, m_ioMutex{xSemaphoreCreateMutex()}
+{
+    assert(nvsNamespace && strlen(nvsNamespace) < NVS_KEY_NAME_MAX_SIZE);
+    assert(m_ioMutex);
+    if (auto access = m_db.getReadAccess())
+    {
+        m_flushedRevision = access->revision();
+    }
+}
+
+ConfigDbStore::~ConfigDbStore()
+{
+    stop();
+    vSemaphoreDelete(m_ioMutex);
+}
+
+bool ConfigDbStore::readKey(SettingKey key, std::string &value)
+{
+    nvs_handle_t handle;
+    if (ESP_OK != nvs_open(m_namespace, NVS_READONLY, &handle))
+    {
+        return false; // the namespace does not exist (yet)
+    }
+    std::string blob;
+    std::string_view name, stored;
+    const bool found = findProbe(handle, key.name, key.hash, blob).found && splitBlob(blob, name, stored);
+    nvs_close(handle);
+    if (found)
+    {
+        value.assign(stored.data(), stored.size());
+    }
+    return found;
+}
+
+bool ConfigDbStore::readAll(std::vector<std::pair<std::string, std::string>> &loaded)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(m_namespace, NVS_READONLY, &handle);
+    if (err == ESP_OK)
+    {
+        std::vector<std::string> keys;
+        if (!forEachBlobKey(m_namespace, [&keys](const char *key) { keys.emplace_back(key); }))
+        {
+            ESP_LOGE(TAG, "failed to iterate namespace '%s'", m_namespace);
+            nvs_close(handle);
+            return false;
+        }
+        loaded.reserve(keys.size());
+        std::string blob;
+        for (const auto &key : keys)
+        {
+            std::string_view name, value;
+            if (!getBlob(handle, key.c_str(), blob) || !splitBlob(blob, name, value))
+            {
+                ESP_LOGW(TAG, "skipping unreadable entry '%s' of '%s'", key.c_str(), m_namespace);
+                continue;
+            }
+            loaded.emplace_back(std::string(name), std::string(value));
+        }
+        nvs_close(handle);
+    }
+    else if (err != ESP_ERR_NVS_NOT_FOUND)
+    {
+        ESP_LOGE(TAG, "nvs_open('%s') failed: %s", m_namespace, esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+bool ConfigDbStore::loadAll()
+{
+    IoLock io(m_ioMutex);
+    std::vector<std::pair<std::string, std::string>> loaded; // blobs, read before taking the WriteAccess
+    if (!readAll(loaded))
+    {
+        return false;
+    }
+
+    size_t inserted = 0;
+    if (auto db = m_db.getWriteAccess())
+    {
+        for (auto &entry : loaded)
+        {
+            const SettingKey key{entry.first};
+            // values set or erased since the last flush are newer than what is in flash
+            if (!db->settings.contains(key) && db->changedAt(key) <= m_flushedRevision &&
+                std::find(m_pendingErases.begin(), m_pendingErases.end(), SettingName(key)) == m_pendingErases.end())
+            {
+                db->settings.try_emplace(db->makeName(entry.first), db->makeValue(entry.second));
+                inserted++;
+            }
+        }
+    }
+    else
+    {
+        return false;
+    }
+    m_allLoaded.store(true, std::memory_order_release);
+    m_probed.clear();
+    ESP_LOGI(TAG, "loaded %u of %u settings from '%s'", (unsigned)inserted, (unsigned)loaded.size(), m_namespace);
+    return true;
+}
+
+// Only `settings` mirror NVS: a key that is not there can still be in flash, even if MyConfigDb has a default for it.
+std::optional<std::string> ConfigDbStore::get(SettingKey key)
+{
+    if (auto db = m_db.getReadAccess())
+    {
+        auto it = db->settings.find(key);
+        if (it != db->settings.end() || m_allLoaded.load(std::memory_order_acquire))
+        {
+            return copyOf(db->get(key));
+        }
+    }
+
+    IoLock io(m_ioMutex);
+    bool probe = !m_allLoaded.load(std::memory_order_relaxed) && !m_probed.contains(key) &&
+                 std::find(m_pendingErases.begin(), m_pendingErases.end(), SettingName(key)) == m_pendingErases.end();
+    if (probe)
+    {
+        m_probed.try_emplace(SettingName(key), true);
+        // no flush can run while we hold m_ioMutex, so a change newer than m_flushedRevision is not in flash yet
+        if (auto db = m_db.getReadAccess())
+        {
+            probe = !db->settings.contains(key) && db->changedAt(key) <= m_flushedRevision;
+        }
+    }
+    std::string value;
+    if (probe && readKey(key, value))
+    {
+        if (auto db = m_db.getWriteAccess())
+        {
+            // unless it was set or erased meanwhile
+            if (!db->settings.contains(key) && db->changedAt(key) <= m_flushedRevision)
+            {
+                db->settings.try_emplace(db->makeName(key), db->makeValue(value));
+                return value;
+            }
+            return copyOf(db->get(key));
+        }
+    }
+    if (auto db = m_db.getReadAccess())
+    {
+        return copyOf(db->get(key));
+    }
+    return std::nullopt;
+}
+
+void ConfigDbStore::erase(SettingKey key)
+{
+    IoLock io(m_ioMutex);
+    if (auto db = m_db.getWriteAccess())
+    {
+        if (!db->erase(key))
+        {
+            // not in RAM, maybe in flash. Written with the next flush, which the release of this access triggers.
+            const SettingName name(key);
+            if (std::find(m_pendingErases.begin(), m_pendingErases.end(), name) == m_pendingErases.end())
+            {
+                m_pendingErases.push_back(name);
+            }
+        }
+    }
+}
+
+bool ConfigDbStore::writeBatch(const std::vector<Change> &batch)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(m_namespace, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "nvs_open('%s') failed: %s", m_namespace, esp_err_to_name(err));
+        return false;
+    }
+    for (const auto &change : batch)
+    {
+        err = change.value ? setName(handle, change.name.str(), change.name.hash(), *change.value)
+                           : eraseName(handle, change.name.str(), change.name.hash());
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "writing '%s' failed: %s", change.name.c_str(), esp_err_to_name(err));
+            break;
+        }
+        m_keysWritten.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+bool ConfigDbStore::flush()
+{
+    IoLock io(m_ioMutex);
+    std::vector<Change> batch;
+    uint32_t revision = 0;
+    // erases of keys that were not in RAM first, a set() after them is newer
+    for (const auto &name : m_pendingErases)
+    {
+        batch.push_back(Change{name, std::nullopt});
+    }
+    bool tracked = true;
+    if (auto db = m_db.getReadAccess())
+    {
+        revision = db->revision();
+        // what is in `settings`: a key reverted to its default is erased from flash
+        const auto &settings = db->settings;
+        tracked = db->forEachChangedSince(m_flushedRevision, [&batch, &settings](SettingKey key, std::optional<std::string_view>) {
+            auto it = settings.find(key);
+            batch.push_back(Change{SettingName(key), it != settings.end() ? std::optional<std::string>(it->second) : std::nullopt});
+        });
+        if (!tracked)
+        {
+            // the changes since the last flush were forgotten (forgetChangesUpTo() past it): write all settings
+            for (const auto &entry : settings)
+            {
+                batch.push_back(Change{SettingName(entry.first.key()), std::string(entry.second)});
+            }
+        }
+    }
+    else
+    {
+        return false;
+    }
+    if (!tracked && !addForgottenErases(batch))
+    {
+        return false;
+    }
+    if (batch.empty())
+    {
+        return true;
+    }
+
+    // the access is released: flash writes only block other flushes
+    if (!writeBatch(batch))
+    {
+        return false; // all of it again next time
+    }
+    m_flushedRevision = revision;
+    m_pendingErases.clear();
+    // flash has them now: the change records are not needed any more. Queued, so the flush never waits for a writer.
+    m_db.postWrite([revision](MyConfigDb &db) { db.forgetChangesUpTo(revision); });
+    m_flushes.fetch_add(1, std::memory_order_relaxed);
+    ESP_LOGD(TAG, "flushed %u changes to '%s'", (unsigned)batch.size(), m_namespace);
+    return true;
+}
+
+// After a flush without the change records: erase what flash has beyond `batch`. A key that is neither in RAM nor
+// was looked up can still be one that was never loaded, so without loadAll() those are kept.
+bool ConfigDbStore::addForgottenErases(std::vector<Change> &batch)
+{
+    std::vector<std::pair<std::string, std::string>> stored;
+    if (!readAll(stored))
+    {
+        return false;
+    }
+    const bool allLoaded = m_allLoaded.load(std::memory_order_relaxed);
+    FlatMap<SettingName, bool, SettingName::Less> written;
+    for (const auto &change : batch)
+    {
+        written.try_emplace(change.name, true);
+    }
+    size_t kept = 0;
+    for (const auto &entry : stored)
+    {
+        const SettingKey key{entry.first};
+        if (written.contains(key))
+        {
+            continue;
+        }
+        if (allLoaded || m_probed.contains(key))
+        {
+            batch.push_back(Change{SettingName(key), std::nullopt});
+        }
+        else
+        {
+            kept++;
+        }
+    }
+    if (kept)
+    {
+        ESP_LOGW(TAG, "change records of '%s' were forgotten before the flush: kept %u keys that may have been erased",
+                 m_namespace, (unsigned)kept);
+    }
+    return true;
+}
+
+void ConfigDbStore::taskFunc(void *arg)
+{
+    ConfigDbStore &self = *static_cast<ConfigDbStore *>(arg);
+    const TickType_t coalesce = pdMS_TO_TICKS(self.m_coalesceMs);
+    // without a free subscriber slot, poll the revision instead
+    const bool subscribed = self.m_db.subscribe(changedBit);
+    if (!subscribed)
+    {
+        ESP_LOGW(TAG, "no subscriber slot left, polling every %u ms", (unsigned)self.m_coalesceMs);
+    }
+    bool pending = true; // catch up with writes made before subscribing
+    for (;;)
+    {
+        uint32_t bits = 0;
+        const TickType_t wait = (subscribed && !pending) ? portMAX_DELAY : std::max<TickType_t>(coalesce, 1);
+        if (pdTRUE == xTaskNotifyWait(0, UINT32_MAX, &bits, wait) && !(bits & stopBit))
+        {
+            vTaskDelay(coalesce); // writes in quick succession go into the same flush
+            xTaskNotifyWait(0, UINT32_MAX, &bits, 0);
+        }
+        if (bits & stopBit)
+        {
+            break;
+        }
+        pending = !self.flush(); // retry failed writes after coalesceMs
+    }
+    if (subscribed)
+    {
+        self.m_db.unsubscribe();
+    }
+    xSemaphoreGive(self.m_stopped);
+    vTaskDelete(nullptr);
+}
+
+bool ConfigDbStore::start(UBaseType_t priority, uint32_t coalesceMs)
+{
+    if (m_task.load(std::memory_order_acquire))
+    {
+        return true;
+    }
+    m_coalesceMs = coalesceMs;
+    m_stopped = xSemaphoreCreateBinary();
+    TaskHandle_t task = nullptr;
+    if (!m_stopped || pdPASS != xTaskCreate(taskFunc, "cDbStore", 4096, this, priority, &task))
+    {
+        ESP_LOGE(TAG, "failed to create the write-behind task");
+        if (m_stopped)
+        {
+            vSemaphoreDelete(m_stopped);
+            m_stopped = nullptr;
+        }
+        return false;
+    }
+    m_task.store(task, std::memory_order_release);
+    return true;
+}
+
+void ConfigDbStore::stop()
+{
+    TaskHandle_t task = m_task.exchange(nullptr, std::memory_order_acq_rel);
+    if (task)
+    {
+        xTaskNotify(task, stopBit, eSetBits);
+        xSemaphoreTake(m_stopped, portMAX_DELAY);
+        vSemaphoreDelete(m_stopped);
+        m_stopped = nullptr;
+    }
+    flush();
+}
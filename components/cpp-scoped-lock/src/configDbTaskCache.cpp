@@ -0,0 +1,160 @@
+/*
+ * configDbTaskCache.cpp
+ *  Per task cache of typed MyConfigDb values, see ConfigDbTaskCache.hpp.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_SCOPED_LOCK_TASK_CACHE
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "ConfigDbTaskCache.hpp"
+#include "FlatMap.hpp"
+
+static_assert(ConfigDbTaskCache::tlsIndex >= 0 && ConfigDbTaskCache::tlsIndex < configNUM_THREAD_LOCAL_STORAGE_POINTERS,
+              "CONFIG_SCOPED_LOCK_TASK_CACHE_TLS_INDEX must be below CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS");
+
+namespace
+{
+    struct Slot
+    {
+        SettingType type;
+        bool found;
+        SettingValue value;
+    };
+
+    // The values one task read through one cache
+    struct CacheValues
+    {
+        uint32_t cacheId;
+        uint32_t generation; // of the manager when the values were read
+        FlatMap<SettingName, Slot, SettingName::Less> slots;
+    };
+
+    // What the thread local storage pointer of a task points to. A task uses few caches: a linear search is enough.
+    struct TaskValues
+    {
+        std::vector<std::unique_ptr<CacheValues>> caches;
+    };
+
+    std::atomic<uint32_t> s_nextCacheId{1};
+
+    void deleteTaskValues(int, void *values)
+    {
+        delete static_cast<TaskValues *>(values);
+    }
+
+    TaskValues &taskValues()
+    {
+        void *p = pvTaskGetThreadLocalStoragePointer(nullptr, ConfigDbTaskCache::tlsIndex);
+        if (!p)
+        {
+            p = new TaskValues{};
+#if configTHREAD_LOCAL_STORAGE_DELETE_CALLBACKS
+            vTaskSetThreadLocalStoragePointerAndDelCallback(nullptr, ConfigDbTaskCache::tlsIndex, p, deleteTaskValues);
+#else
+            // without deletion callbacks, call releaseTask() before a task deletes itself
+            vTaskSetThreadLocalStoragePointer(nullptr, ConfigDbTaskCache::tlsIndex, p);
+#endif
+        }
+        return *static_cast<TaskValues *>(p);
+    }
+
+    CacheValues &cacheValues(uint32_t cacheId)
+    {
+        TaskValues &task = taskValues();
+        for (auto &c : task.caches)
+        {
+            if (c->cacheId == cacheId)
+            {
+                return *c;
+            }
+        }
+        task.caches.emplace_back(new CacheValues{cacheId, MyConfigDbManager::noGeneration, {}});
+        return *task.caches.back();
+    }
+} // namespace
+
+ConfigDbTaskCache::ConfigDbTaskCache(MyConfigDbManager &dbMan)
+    : m_dbMan{dbMan},
+      m_id{s_nextCacheId.fetch_add(1, std::memory_order_relaxed)}
+{
+}
+
+void ConfigDbTaskCache::releaseTask()
+{
+    void *p = pvTaskGetThreadLocalStoragePointer(nullptr, tlsIndex);
+    if (p)
+    {
+        vTaskSetThreadLocalStoragePointer(nullptr, tlsIndex, nullptr);
+        deleteTaskValues(tlsIndex, p);
+    }
+}
+
+bool ConfigDbTaskCache::lookup(SettingKey key, SettingType type, SettingValue &value)
+{
+    // read before the ReadAccess below: a write in between makes the next lookup refill again, never keeps old values
+    const uint32_t generation = m_dbMan.generation();
+    CacheValues &values = cacheValues(m_id);
+    if (values.generation != generation)
+    {
+        values.slots.clear(); // keeps the capacity for the refill
+        values.generation = generation;
+    }
+    auto it = values.slots.find(key);
+    if (it != values.slots.end() && it->second.type == type)
+    {
+        value = it->second.value;
+        return it->second.found;
+    }
+
+    Slot slot{type, false, {}};
+    if (auto db = m_dbMan.getReadAccess())
+    {
+        switch (type)
+        {
+        case SettingType::Int:
+        case SettingType::Enum:
+            if (auto v = db->getInt(key))
+            {
+                slot = Slot{type, true, SettingValue(*v)};
+            }
+            break;
+        case SettingType::Float:
+            if (auto v = db->getFloat(key))
+            {
+                slot = Slot{type, true, SettingValue(*v)};
+            }
+            break;
+        case SettingType::Bool:
+            if (auto v = db->getBool(key))
+            {
+                slot = Slot{type, true, SettingValue(*v)};
+            }
+            break;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    if (it != values.slots.end())
+    {
+        it->second = slot;
+    }
+    else
+    {
+        values.slots.try_emplace(SettingName(key), slot);
+    }
+    value = slot.value;
+    return slot.found;
+}
+
+#endif // CONFIG_SCOPED_LOCK_TASK_CACHE
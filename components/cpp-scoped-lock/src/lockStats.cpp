@@ -0,0 +1,35 @@
+/*
+ * lockStats.cpp
+ *  Logging of LockableObject contention statistics.
+ */
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "LockStats.hpp"
+
+static void logSide(const char *tag, const char *name, const char *kind, const LockStatsSnapshot::Side &side)
+{
+    const uint32_t avgHoldUs = side.acquired ? static_cast<uint32_t>(side.totalHoldUs / side.acquired) : 0;
+    ESP_LOGI(tag, "%s %s: %u attempts, %u acquired, %u timeouts, wait max %u us, hold max %u us avg %u us",
+             name, kind, (unsigned)side.attempts, (unsigned)side.acquired, (unsigned)side.timeouts,
+             (unsigned)side.maxWaitUs, (unsigned)side.maxHoldUs, (unsigned)avgHoldUs);
+    ESP_LOGI(tag, "%s %s wait histogram: <10us %u, <100us %u, <1ms %u, <10ms %u, <100ms %u, >=100ms %u",
+             name, kind, (unsigned)side.waitHistogram[0], (unsigned)side.waitHistogram[1], (unsigned)side.waitHistogram[2],
+             (unsigned)side.waitHistogram[3], (unsigned)side.waitHistogram[4], (unsigned)side.waitHistogram[5]);
+}
+
+void logLockStats(const char *tag, const char *name, const LockStatsSnapshot &stats)
+{
+    if (!stats.enabled)
+    {
+        ESP_LOGI(tag, "%s: lock statistics disabled (CONFIG_SCOPED_LOCK_STATS)", name);
+        return;
+    }
+    logSide(tag, name, "read", stats.read);
+    logSide(tag, name, "write", stats.write);
+    if (stats.writer)
+    {
+        ESP_LOGI(tag, "%s: write lock held by task '%s'", name, pcTaskGetName(stats.writer));
+    }
+}
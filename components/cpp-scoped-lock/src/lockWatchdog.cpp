@@ -0,0 +1,173 @@
+/*
+ * lockWatchdog.cpp
+ *  Slot table and task of the LockableObject hold-time watchdog, see LockWatchdog.hpp.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+
+#include <atomic>
+
+#include "esp_log.h"
+#include "LockWatchdog.hpp"
+
+constexpr auto *TAG = "LockWatchdog";
+
+namespace
+{
+    // One tracked access. The owner publishes the fields seqlock-style (seq is odd while they change),
+    // so the watchdog never reports a mix of two different holds.
+    struct Slot
+    {
+        std::atomic<uint32_t> claimed{0};
+        std::atomic<uint32_t> seq{0};
+        std::atomic<const void *> object{nullptr};
+        std::atomic<TaskHandle_t> task{nullptr};
+        std::atomic<TickType_t> since{0};
+        std::atomic<bool> write{false};
+    };
+
+    Slot s_slots[LockWatchdog::numSlots];
+    std::atomic<uint32_t> s_reportedSeq[LockWatchdog::numSlots]; // last reported hold per slot, claimed by check()
+    std::atomic<uint32_t> s_untracked{0};
+    std::atomic<LockWatchdog::Handler> s_handler{nullptr};
+    std::atomic<TaskHandle_t> s_task{nullptr};
+    uint32_t s_thresholdMs = 0;
+
+    void logReport(const LockHoldReport &report)
+    {
+        ESP_LOGW(TAG, "%s lock on %p held by task '%s' for %u ms", report.write ? "write" : "read", report.object,
+                 report.task ? pcTaskGetName(report.task) : "?", (unsigned)report.heldMs);
+    }
+
+    void watchdogTask(void *)
+    {
+        const TickType_t period = pdMS_TO_TICKS(s_thresholdMs / 2) ? pdMS_TO_TICKS(s_thresholdMs / 2) : 1;
+        for (;;)
+        {
+            vTaskDelay(period);
+            LockWatchdog::check(s_thresholdMs);
+        }
+    }
+} // namespace
+
+int LockWatchdog::enter(const void *object, bool write)
+{
+    // start searching at a task dependent slot, so concurrent tasks rarely compete for the same one
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    const std::size_t first = (reinterpret_cast<uintptr_t>(self) >> 4) % numSlots;
+    for (std::size_t n = 0; n < numSlots; n++)
+    {
+        const std::size_t i = (first + n) % numSlots;
+        Slot &slot = s_slots[i];
+        uint32_t expected = 0;
+        if (slot.claimed.load(std::memory_order_relaxed) == 0 &&
+            slot.claimed.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+            slot.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.object.store(object, std::memory_order_relaxed);
+            slot.task.store(self, std::memory_order_relaxed);
+            slot.since.store(xTaskGetTickCount(), std::memory_order_relaxed);
+            slot.write.store(write, std::memory_order_relaxed);
+            slot.seq.store(seq + 2, std::memory_order_release);
+            return static_cast<int>(i);
+        }
+    }
+    s_untracked.fetch_add(1, std::memory_order_relaxed);
+    return -1;
+}
+
+void LockWatchdog::leave(int slotIndex)
+{
+    Slot &slot = s_slots[slotIndex];
+    const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.object.store(nullptr, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+    slot.claimed.store(0, std::memory_order_release);
+}
+
+std::size_t LockWatchdog::check(uint32_t thresholdMs)
+{
+    const TickType_t now = xTaskGetTickCount();
+    const TickType_t threshold = pdMS_TO_TICKS(thresholdMs);
+    const Handler handler = s_handler.load(std::memory_order_acquire);
+    std::size_t reports = 0;
+    for (std::size_t i = 0; i < numSlots; i++)
+    {
+        Slot &slot = s_slots[i];
+        const uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        uint32_t reported = s_reportedSeq[i].load(std::memory_order_relaxed);
+        if ((seq & 1) || seq == reported)
+        {
+            continue; // being updated, or already reported
+        }
+        LockHoldReport report{};
+        report.object = slot.object.load(std::memory_order_relaxed);
+        report.task = slot.task.load(std::memory_order_relaxed);
+        report.write = slot.write.load(std::memory_order_relaxed);
+        const TickType_t since = slot.since.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq || report.object == nullptr)
+        {
+            continue; // released (or replaced) while we looked
+        }
+        const TickType_t held = now - since;
+        if (held <= threshold)
+        {
+            continue;
+        }
+        report.heldMs = static_cast<uint32_t>(held) * portTICK_PERIOD_MS;
+        if (!s_reportedSeq[i].compare_exchange_strong(reported, seq, std::memory_order_relaxed))
+        {
+            continue; // a concurrent check() (i.e. the watchdog task) claimed this report
+        }
+        (handler ? handler : logReport)(report);
+        reports++;
+    }
+    return reports;
+}
+
+bool LockWatchdog::start(uint32_t thresholdMs, UBaseType_t priority)
+{
+    if (s_task.load(std::memory_order_acquire))
+    {
+        return true;
+    }
+    s_thresholdMs = thresholdMs;
+    TaskHandle_t task = nullptr;
+    if (pdPASS != xTaskCreate(watchdogTask, "lockWdt", 2048, nullptr, priority, &task))
+    {
+        ESP_LOGE(TAG, "failed to create the watchdog task");
+        return false;
+    }
+    s_task.store(task, std::memory_order_release);
+    return true;
+}
+
+void LockWatchdog::setHandler(Handler handler)
+{
+    s_handler.store(handler, std::memory_order_release);
+}
+
+uint32_t LockWatchdog::untracked()
+{
+    return s_untracked.load(std::memory_order_relaxed);
+}
+
+#else // watchdog disabled: keep the API, track nothing
+
+#include "LockWatchdog.hpp"
+
+int LockWatchdog::enter(const void *, bool) { return -1; }
+void LockWatchdog::leave(int) {}
+bool LockWatchdog::start(uint32_t, UBaseType_t) { return false; }
+void LockWatchdog::setHandler(Handler) {}
+std::size_t LockWatchdog::check(uint32_t) { return 0; }
+uint32_t LockWatchdog::untracked() { return 0; }
+
+#endif // CONFIG_SCOPED_LOCK_WATCHDOG
@@ -0,0 +1,137 @@
+/*
+ * typedSettings.cpp
+ *  String conversion of the values of TypedSettings, see TypedSettings.hpp.
+ */
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+#include "TypedSettings.hpp"
+
+bool settingValueValid(const SettingDef &def, SettingValue value)
+{
+    switch (def.type)
+    {
+    case SettingType::Int:
+    case SettingType::Enum:
+        return value.i >= def.min && value.i <= def.max;
+    case SettingType::Float:
+        return std::isfinite(value.f);
+    case SettingType::Bool:
+        return true;
+    }
+    return false;
+}
+
+bool settingValueEquals(const SettingDef &def, SettingValue a, SettingValue b)
+{
+    switch (def.type)
+    {
+    case SettingType::Int:
+    case SettingType::Enum:
+        return a.i == b.i;
+    case SettingType::Float:
+        return a.f == b.f;
+    case SettingType::Bool:
+        return a.b == b.b;
+    }
+    return false;
+}
+
+bool settingFromString(const SettingDef &def, std::string_view text, SettingValue &value)
+{
+    SettingValue parsed;
+    switch (def.type)
+    {
+    case SettingType::Int:
+    {
+        auto i = MyConfigDb::parseInt(text);
+        if (!i)
+        {
+            return false;
+        }
+        parsed = SettingValue(*i);
+        break;
+    }
+    case SettingType::Float:
+    {
+        auto f = MyConfigDb::parseFloat(text);
+        if (!f)
+        {
+            return false;
+        }
+        parsed = SettingValue(*f);
+        break;
+    }
+    case SettingType::Bool:
+    {
+        auto b = MyConfigDb::parseBool(text);
+        if (!b)
+        {
+            return false;
+        }
+        parsed = SettingValue(*b);
+        break;
+    }
+    case SettingType::Enum:
+    {
+        std::optional<int32_t> found;
+        for (int32_t i = 0; i <= def.max; i++)
+        {
+            if (text == def.names[i])
+            {
+                found = i;
+                break;
+            }
+        }
+        if (!found)
+        {
+            found = MyConfigDb::parseInt(text);
+        }
+        if (!found)
+        {
+            return false;
+        }
+        parsed = SettingValue(*found);
+        break;
+    }
+    }
+    if (!settingValueValid(def, parsed))
+    {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+void settingToString(const SettingDef &def, SettingValue value, std::string &out)
+{
+    char buf[24];
+    switch (def.type)
+    {
+    case SettingType::Int:
+        snprintf(buf, sizeof(buf), "%" PRId32, value.i);
+        out = buf;
+        return;
+    case SettingType::Float:
+        // enough digits to read back the same float
+        snprintf(buf, sizeof(buf), "%.9g", double(value.f));
+        out = buf;
+        return;
+    case SettingType::Bool:
+        out = value.b ? "true" : "false";
+        return;
+    case SettingType::Enum:
+        if (value.i >= def.min && value.i <= def.max)
+        {
+            out = def.names[value.i];
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "%" PRId32, value.i);
+            out = buf;
+        }
+        return;
+    }
+}
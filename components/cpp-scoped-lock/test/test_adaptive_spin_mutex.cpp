@@ -0,0 +1,147 @@
+/*
+  Unit tests for the AdaptiveSpinMutex (spin-then-block) policy of LockableObject.
+*/
+
+#include <algorithm>
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "AdaptiveSpinMutex.hpp"
+#include "PerCoreSharedMutex.hpp"
+
+#define TAG "[AdaptiveSpinMutex]"
+
+using SpinDbManager = LockableObject<MyConfigDb, AdaptiveSpinMutex<>>;
+
+template <class Manager>
+static void checkLocking(Manager &dbMan)
+{
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        auto readLock2 = dbMan.getReadAccess();
+        TEST_ASSERT_TRUE_MESSAGE(bool(readLock2), "Expect to get second read lock.");
+        auto writeLock = dbMan.getWriteAccess(Manager::minBlockTime);
+        TEST_ASSERT_FALSE_MESSAGE(bool(writeLock), "Should not get write lock while read.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get read lock.");
+    }
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        writeLock->set("key", "value");
+        auto readLock = dbMan.getReadAccess(Manager::minBlockTime);
+        TEST_ASSERT_FALSE_MESSAGE(bool(readLock), "Should not get read lock while write.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get write lock.");
+    }
+
+    auto readLock = dbMan.getReadAccess();
+    TEST_ASSERT_TRUE_MESSAGE(bool(readLock), "Expect to get read lock after release write lock.");
+    TEST_ASSERT_TRUE(readLock->get("key") == "value");
+}
+
+TEST_CASE("AdaptiveSpinMutex locking", TAG)
+{
+    SpinDbManager dbMan{};
+    checkLocking(dbMan);
+
+    LockableObject<MyConfigDb, AdaptiveSpinMutex<PerCoreSharedMutex, 64>> perCoreMan{};
+    checkLocking(perCoreMan);
+}
+
+TEST_CASE("AdaptiveSpinMutex learns to stop spinning on long holds", TAG)
+{
+    AdaptiveSpinMutex<> mutex{};
+    if (!AdaptiveSpinMutex<>::spinning)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, mutex.spinBudget(true));
+        TEST_IGNORE_MESSAGE("Single core build, never spins.");
+    }
+    const uint32_t initial = mutex.spinBudget(false);
+
+    mutex.lock();
+    for (int i = 0; i < 32; i++)
+    {
+        // the write lock is held all along, so every spin fails
+        TEST_ASSERT_FALSE(mutex.try_lock_shared_for(std::chrono::milliseconds(1)));
+    }
+    mutex.unlock();
+
+    ESP_LOGI(TAG, "read spin budget %u -> %u", (unsigned)initial, (unsigned)mutex.spinBudget(false));
+    TEST_ASSERT_LESS_THAN_UINT32(initial / 4, mutex.spinBudget(false));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(initial, mutex.spinBudget(true), "The write side learns separately.");
+}
+
+static SpinDbManager g_SpinDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static volatile int s_writes = 0;
+
+// Short write sections back to back, from the other core
+static void shortWriterFunc(void *)
+{
+    xSemaphoreGive(s_done_semphr);
+    int i = 0;
+    while (!s_stop)
+    {
+        if (auto dbAccess = g_SpinDbManager.getWriteAccess())
+        {
+            s_writes = s_writes + 1;
+        }
+        if (++i % 64 == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("AdaptiveSpinMutex reader latency against short writes", TAG)
+{
+    const int N = 20000;
+    s_stop = false;
+    s_writes = 0;
+    s_done_semphr = xSemaphoreCreateCounting(1, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    xTaskCreatePinnedToCore(shortWriterFunc, "SpinWriter", 2048, nullptr, ESP_TASK_MAIN_PRIO, nullptr, portNUM_PROCESSORS - 1);
+    xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+
+    int failures = 0;
+    int64_t worstUs = 0;
+    const int64_t start = esp_timer_get_time();
+    for (int i = 0; i < N; i++)
+    {
+        const int64_t t0 = esp_timer_get_time();
+        if (auto dbAccess = g_SpinDbManager.getReadAccess(std::chrono::milliseconds(100)))
+        {
+            worstUs = std::max(worstUs, esp_timer_get_time() - t0);
+        }
+        else
+        {
+            failures++;
+        }
+    }
+    const int64_t elapsed = esp_timer_get_time() - start;
+
+    s_stop = true;
+    xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    vSemaphoreDelete(s_done_semphr);
+
+    ESP_LOGI(TAG, "%d reads in %lld us, worst %lld us, %d writes meanwhile", N, (long long)elapsed, (long long)worstUs, s_writes);
+    TEST_ASSERT_EQUAL_MESSAGE(0, failures, "Expected no read locks to fail.");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, s_writes, "Expected the writer to make progress.");
+}
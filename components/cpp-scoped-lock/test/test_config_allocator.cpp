@@ -0,0 +1,121 @@
+/*
+  Unit tests for the allocators of MyConfigDb (ConfigAllocator.hpp).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include <memory>
+#include <string>
+
+#include "unity.h"
+#include "ConfigAllocator.hpp"
+#include "MyConfigDb.hpp"
+
+#define TAG "[ConfigAllocator]"
+
+static const std::string LONG_VALUE(30, 'v'); // beyond the SSO limit, so it has its own allocation
+
+TEST_CASE("ConfigPoolAllocator hands out fixed blocks", TAG)
+{
+    ConfigPoolAllocator pool{40, 4};
+    TEST_ASSERT_EQUAL(48, pool.blockSize()); // rounded up to the alignment
+    void *a = pool.allocate(40);
+    void *b = pool.allocate(1);
+    TEST_ASSERT_EQUAL(2, pool.blocksUsed());
+    TEST_ASSERT_EQUAL_PTR(static_cast<uint8_t *>(a) + pool.blockSize(), b);
+
+    void *large = pool.allocate(100);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, pool.fallbacks(), "Expected a heap allocation for a large request.");
+    pool.deallocate(large, 100);
+
+    pool.deallocate(a, 40);
+    TEST_ASSERT_EQUAL_PTR(a, pool.allocate(16)); // the freed block is reused
+    void *c = pool.allocate(8), *d = pool.allocate(8);
+    TEST_ASSERT_EQUAL(4, pool.blocksUsed());
+    void *e = pool.allocate(8);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, pool.fallbacks(), "Expected a heap allocation from an empty pool.");
+    for (void *p : {a, b, c, d, e})
+    {
+        pool.deallocate(p, 8);
+    }
+    TEST_ASSERT_EQUAL(0, pool.blocksUsed());
+}
+
+TEST_CASE("ConfigArenaAllocator bumps and starts over when empty", TAG)
+{
+    ConfigArenaAllocator arena{256};
+    void *a = arena.allocate(20);
+    void *b = arena.allocate(20);
+    TEST_ASSERT_EQUAL_PTR(static_cast<uint8_t *>(a) + 32, b);
+    TEST_ASSERT_EQUAL(64, arena.used());
+    arena.deallocate(a, 20);
+    TEST_ASSERT_EQUAL_MESSAGE(64, arena.used(), "Freed memory is not reused while the arena is in use.");
+
+    void *large = arena.allocate(300);
+    TEST_ASSERT_EQUAL_UINT32(1, arena.fallbacks());
+    arena.deallocate(large, 300);
+
+    arena.deallocate(b, 20);
+    TEST_ASSERT_EQUAL_MESSAGE(0, arena.used(), "Expected to start over once everything was freed.");
+    TEST_ASSERT_EQUAL_PTR(a, arena.allocate(8));
+}
+
+TEST_CASE("MyConfigDb values and index from chosen allocators", TAG)
+{
+    ConfigPoolAllocator valuePool{64, 100};
+    ConfigArenaAllocator indexArena{16 * 1024};
+    ConfigAllocator::use(&indexArena, &valuePool);
+    {
+        auto dbMan = std::make_unique<MyConfigDbManager>();
+        ConfigAllocator::use(nullptr, nullptr); // the database keeps what it was created with
+
+        if (auto db = dbMan->getWriteAccess())
+        {
+            db->settings.reserve(100); // an arena can't reuse what growing the block frees
+            for (int i = 0; i < 50; i++)
+            {
+                db->set("long" + std::to_string(i), LONG_VALUE);
+                db->set("short" + std::to_string(i), "1");
+            }
+        }
+        TEST_ASSERT_EQUAL_MESSAGE(50, valuePool.blocksUsed(), "Expected one block per long value, none for short ones.");
+        TEST_ASSERT_EQUAL_UINT32(0, valuePool.fallbacks());
+        TEST_ASSERT_GREATER_THAN(0, indexArena.used());
+        TEST_ASSERT_EQUAL_UINT32(0, indexArena.fallbacks());
+
+        TEST_ASSERT_TRUE(dbMan->getWriteAccess()->erase("long7"));
+        TEST_ASSERT_EQUAL(49, valuePool.blocksUsed());
+
+        // a copy (i.e. a snapshot) allocates from the same pool
+        MyConfigDb copy{};
+        if (auto db = dbMan->getReadAccess())
+        {
+            copy = *db.operator->();
+        }
+        TEST_ASSERT_EQUAL(98, valuePool.blocksUsed());
+        TEST_ASSERT_TRUE(copy.get("long3") == std::string_view(LONG_VALUE));
+
+        dbMan->reset();
+        TEST_ASSERT_EQUAL(49, valuePool.blocksUsed());
+        dbMan->getWriteAccess()->set("later", LONG_VALUE);
+        TEST_ASSERT_EQUAL_MESSAGE(49, valuePool.blocksUsed(), "A reset database takes the allocators in use now.");
+    }
+    TEST_ASSERT_EQUAL(0, valuePool.blocksUsed());
+    TEST_ASSERT_EQUAL(0, indexArena.used());
+}
+
+TEST_CASE("MyConfigDb long names from the values allocator", TAG)
+{
+    ConfigPoolAllocator valuePool{64, 8};
+    ConfigAllocator::use(nullptr, &valuePool);
+    {
+        MyConfigDb db{};
+        ConfigAllocator::use(nullptr, nullptr);
+        db.set("network.wifi.station.reconnect_ms", "1");
+        TEST_ASSERT_GREATER_THAN_MESSAGE(0, valuePool.blocksUsed(), "Expected the long name in the pool.");
+        TEST_ASSERT_EQUAL_UINT32(0, valuePool.fallbacks());
+    }
+    TEST_ASSERT_EQUAL(0, valuePool.blocksUsed());
+}
@@ -0,0 +1,156 @@
+/*
+  Unit tests for the binary serialization of MyConfigDb (ConfigBlob.hpp).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include <string>
+#include <vector>
+
+#include "unity.h"
+#include "ConfigBlob.hpp"
+#include "MyConfigDb.hpp"
+
+#define TAG "[ConfigBlob]"
+
+// db: a MyConfigDb* or a WriteAccess
+template <class Db>
+static void fillSettings(const Db &db, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        const std::string prefix = "module" + std::to_string(i);
+        db->set(prefix + ".enabled", i % 3 ? "true" : "false");
+        db->set(prefix + ".mode", "automatic");
+        db->set(prefix + ".id", std::to_string(i * 7919));
+    }
+    db->set("empty", "");
+    db->set("binary", std::string_view("a\0b", 3));
+}
+
+template <class A, class B>
+static bool sameSettings(const A &a, const B &b)
+{
+    if (a->settings.size() != b->settings.size())
+    {
+        return false;
+    }
+    for (const auto &entry : a->settings)
+    {
+        if (b->get(entry.first.key()) != std::string_view(entry.second))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("ConfigBlob round trip, with and without dictionary", TAG)
+{
+    MyConfigDbManager dbMan{};
+    fillSettings(dbMan.getWriteAccess(), 20);
+
+    std::vector<uint8_t> plain, compact;
+    dbMan.getReadAccess()->serialize(plain, false);
+    dbMan.getReadAccess()->serialize(compact);
+    ESP_LOGI(TAG, "%u settings: %u bytes, %u with dictionary", (unsigned)dbMan.getReadAccess()->settings.size(),
+             (unsigned)plain.size(), (unsigned)compact.size());
+    TEST_ASSERT_LESS_THAN(plain.size(), compact.size());
+
+    for (const auto *blob : {&plain, &compact})
+    {
+        ConfigBlobView view{blob->data(), blob->size()};
+        TEST_ASSERT_TRUE(view.valid());
+        TEST_ASSERT_EQUAL(62, view.count());
+        TEST_ASSERT_EQUAL(blob->size(), view.size());
+
+        MyConfigDbManager loaded{};
+        TEST_ASSERT_TRUE(loaded.getWriteAccess()->load(view));
+        TEST_ASSERT_TRUE(sameSettings(dbMan.getReadAccess(), loaded.getReadAccess()));
+    }
+}
+
+TEST_CASE("ConfigBlobView reads in place", TAG)
+{
+    MyConfigDb db{};
+    fillSettings(&db, 4);
+    std::vector<uint8_t> blob;
+    db.serialize(blob);
+    const char *begin = reinterpret_cast<const char *>(blob.data());
+
+    ConfigBlobView view{blob.data(), blob.size()};
+    TEST_ASSERT_TRUE(view.valid());
+    auto mode = view.find("module2.mode");
+    TEST_ASSERT_TRUE(mode == "automatic");
+    TEST_ASSERT_TRUE_MESSAGE(mode->data() >= begin && mode->data() < begin + blob.size(), "Expected a view into the blob.");
+    TEST_ASSERT_TRUE(view.find("binary") == std::string_view("a\0b", 3));
+    TEST_ASSERT_TRUE(view.find("empty") == "");
+    TEST_ASSERT_FALSE(view.find("missing").has_value());
+
+    // same order as the settings, so loading appends
+    auto it = db.settings.begin();
+    bool inOrder = true;
+    view.forEach([&](std::string_view name, std::string_view value) {
+        inOrder = inOrder && it != db.settings.end() && name == it->first.str() && value == it->second;
+        ++it;
+    });
+    TEST_ASSERT_TRUE(inOrder);
+}
+
+TEST_CASE("ConfigBlobView rejects damaged blobs", TAG)
+{
+    MyConfigDb db{};
+    fillSettings(&db, 4);
+    std::vector<uint8_t> blob;
+    db.serialize(blob);
+
+    TEST_ASSERT_FALSE(ConfigBlobView(blob.data(), blob.size() - 1).valid());
+    TEST_ASSERT_FALSE(ConfigBlobView(blob.data(), 3).valid());
+    TEST_ASSERT_FALSE(ConfigBlobView(nullptr, 0).valid());
+    // a larger buffer is fine, i.e. a whole flash partition
+    std::vector<uint8_t> padded = blob;
+    padded.resize(blob.size() + 100, 0xff);
+    TEST_ASSERT_TRUE(ConfigBlobView(padded.data(), padded.size()).valid());
+
+    for (std::size_t at : {std::size_t(0), std::size_t(4), blob.size() / 2, blob.size() - 1})
+    {
+        std::vector<uint8_t> damaged = blob;
+        damaged[at] ^= 0x20;
+        ConfigBlobView view{damaged.data(), damaged.size()};
+        TEST_ASSERT_FALSE(view.valid());
+        TEST_ASSERT_EQUAL(0, view.count());
+        MyConfigDb target{};
+        TEST_ASSERT_FALSE(target.load(view));
+        TEST_ASSERT_TRUE(target.settings.empty());
+    }
+}
+
+TEST_CASE("ConfigBlob from a snapshot, loaded over existing settings", TAG)
+{
+    MyConfigDbSnapshotManager source{};
+    if (auto db = source.getWriteAccess())
+    {
+        db->set("a", "1");
+        db->set("b", "2");
+    }
+    std::vector<uint8_t> blob;
+    source.getSnapshot()->serialize(blob);
+
+    MyConfigDb db{};
+    db.set("b", "old");
+    db.set("c", "kept");
+    const uint32_t revision = db.revision();
+    TEST_ASSERT_TRUE(db.load(ConfigBlobView(blob.data(), blob.size())));
+    TEST_ASSERT_EQUAL(3, db.settings.size());
+    TEST_ASSERT_TRUE(db.get("b") == "2");
+    TEST_ASSERT_TRUE(db.get("c") == "kept");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(revision + 2, db.revision(), "Loaded keys are tracked changes.");
+
+    MyConfigDb empty{};
+    std::vector<uint8_t> emptyBlob;
+    empty.serialize(emptyBlob);
+    TEST_ASSERT_EQUAL(ConfigBlob::headerSize, emptyBlob.size());
+    TEST_ASSERT_TRUE(ConfigBlobView(emptyBlob.data(), emptyBlob.size()).valid());
+}
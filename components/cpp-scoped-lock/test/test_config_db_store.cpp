@@ -0,0 +1,276 @@
+/*
+  Unit tests for ConfigDbStore, the NVS persistence of MyConfigDbManager.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include <string>
+
+#include "unity.h"
+#include "ConfigDbStore.hpp"
+
+#define TAG "[ConfigDbStore]"
+
+static const char *NVS_NS = "cDbStoreTest";
+static const char *LONG_NAME = "network.wifi.station.reconnect_ms"; // longer than an NVS key
+
+// initialize NVS and empty the test namespace
+static void freshNvs()
+{
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, err);
+    nvs_handle_t handle;
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_open(NVS_NS, NVS_READWRITE, &handle));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_erase_all(handle));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_commit(handle));
+    nvs_close(handle);
+}
+
+static bool waitForFlushes(const ConfigDbStore &store, uint32_t flushes, uint32_t timeoutMs)
+{
+    for (uint32_t waited = 0; store.flushes() < flushes; waited += 10)
+    {
+        if (waited >= timeoutMs)
+        {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
+}
+
+TEST_CASE("ConfigDbStore writes behind and coalesces", TAG)
+{
+    freshNvs();
+    MyConfigDbManager dbMan{};
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_TRUE(store.start(tskIDLE_PRIORITY + 1, 50));
+
+    for (int i = 0; i < 10; i++)
+    {
+        if (auto db = dbMan.getWriteAccess())
+        {
+            db->set("wifi.ssid", "net" + std::to_string(i));
+        }
+    }
+    dbMan.getWriteAccess()->set(LONG_NAME, "1500");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, store.flushes(), "Nothing is written while the writes go on.");
+
+    TEST_ASSERT_TRUE_MESSAGE(waitForFlushes(store, 1, 2000), "Expected the task to flush.");
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL_UINT32(1, store.flushes());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, store.keysWritten(), "Expected one NVS write per key.");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(dbMan.getReadAccess()->revision(), dbMan.getReadAccess()->forgottenUpTo(),
+                                     "Expected the flushed change records dropped.");
+
+    dbMan.getWriteAccess()->set("wifi.ssid", "final");
+    store.stop(); // flushes what is left
+    TEST_ASSERT_EQUAL_UINT32(3, store.keysWritten());
+
+    MyConfigDbManager reloaded{};
+    ConfigDbStore reloadedStore{reloaded, NVS_NS};
+    TEST_ASSERT_TRUE(reloadedStore.loadAll());
+    if (auto db = reloaded.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL(2, db->settings.size());
+        TEST_ASSERT_TRUE(db->get("wifi.ssid") == "final");
+        TEST_ASSERT_EQUAL(1500, db->getInt(LONG_NAME).value_or(0));
+    }
+    TEST_ASSERT_TRUE(reloadedStore.flush());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, reloadedStore.keysWritten(), "Loaded values are not written back.");
+}
+
+TEST_CASE("ConfigDbStore loads lazily on a miss", TAG)
+{
+    freshNvs();
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        dbMan.getWriteAccess()->set(LONG_NAME, "42");
+        dbMan.getWriteAccess()->set("other", "x");
+        TEST_ASSERT_TRUE(store.flush());
+    }
+
+    MyConfigDbManager dbMan{};
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_FALSE(dbMan.getReadAccess()->contains(LONG_NAME));
+    TEST_ASSERT_TRUE(store.get(LONG_NAME) == std::string("42"));
+    TEST_ASSERT_TRUE_MESSAGE(dbMan.getReadAccess()->contains(LONG_NAME), "Expected the key in RAM after the miss.");
+    TEST_ASSERT_FALSE_MESSAGE(dbMan.getReadAccess()->contains("other"), "Expected only the missed key to be loaded.");
+    TEST_ASSERT_FALSE(store.get("missing").has_value());
+
+    // a newer value in RAM wins over flash
+    dbMan.getWriteAccess()->set("other", "y");
+    TEST_ASSERT_TRUE(store.get("other") == std::string("y"));
+    TEST_ASSERT_TRUE(store.flush());
+    TEST_ASSERT_EQUAL_UINT32(1, store.keysWritten());
+}
+
+TEST_CASE("ConfigDbStore erases keys that were never loaded", TAG)
+{
+    freshNvs();
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        dbMan.getWriteAccess()->set("a", "1");
+        dbMan.getWriteAccess()->set("b", "2");
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        TEST_ASSERT_TRUE(store.get("b").has_value());
+        store.erase("a"); // only in flash
+        dbMan.getWriteAccess()->erase("b"); // loaded, a tracked erase
+        TEST_ASSERT_FALSE_MESSAGE(store.get("a").has_value(), "Expected no reload of a pending erase.");
+        TEST_ASSERT_TRUE(store.flush());
+        TEST_ASSERT_EQUAL_UINT32(2, store.keysWritten());
+    }
+
+    MyConfigDbManager dbMan{};
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_TRUE(store.loadAll());
+    TEST_ASSERT_EQUAL(0, dbMan.getReadAccess()->settings.size());
+}
+
+TEST_CASE("ConfigDbStore keeps only overrides of the defaults", TAG)
+{
+    freshNvs();
+    MyConfigDb factory{};
+    factory.set("wifi.mode", "station");
+    std::vector<uint8_t> defaults;
+    factory.serialize(defaults, true, true);
+    {
+        MyConfigDbManager dbMan{};
+        dbMan.getWriteAccess()->setDefaults(ConfigBlobView(defaults.data(), defaults.size()));
+        ConfigDbStore store{dbMan, NVS_NS};
+        dbMan.getWriteAccess()->set("wifi.mode", "ap");
+        TEST_ASSERT_TRUE(store.flush());
+    }
+
+    MyConfigDbManager dbMan{};
+    dbMan.getWriteAccess()->setDefaults(ConfigBlobView(defaults.data(), defaults.size()));
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_TRUE_MESSAGE(store.get("wifi.mode") == std::string("ap"), "Expected the override from flash, not the default.");
+
+    dbMan.getWriteAccess()->set("wifi.mode", "station"); // back to the default
+    TEST_ASSERT_TRUE(store.flush());
+
+    MyConfigDbManager reloaded{};
+    ConfigDbStore reloadedStore{reloaded, NVS_NS};
+    TEST_ASSERT_TRUE(reloadedStore.loadAll());
+    TEST_ASSERT_EQUAL_MESSAGE(0, reloaded.getReadAccess()->settings.size(), "Expected the override erased from flash.");
+}
+
+TEST_CASE("ConfigDbStore flushes after reset and exchange", TAG)
+{
+    freshNvs();
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        dbMan.getWriteAccess()->set("a", "1");
+        dbMan.getWriteAccess()->set("b", "2");
+        TEST_ASSERT_TRUE(store.flush());
+
+        dbMan.reset();
+        TEST_ASSERT_TRUE(store.flush());
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(4, store.keysWritten(), "Expected the reset keys erased from flash.");
+
+        dbMan.getWriteAccess()->set("c", "3");
+        MyConfigDb replacement{};
+        replacement.set("d", "4");
+        MyConfigDb old = dbMan.exchange(std::move(replacement));
+        TEST_ASSERT_TRUE(old.contains("c"));
+        TEST_ASSERT_TRUE(store.flush());
+    }
+
+    MyConfigDbManager dbMan{};
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_TRUE(store.loadAll());
+    if (auto db = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL(1, db->settings.size());
+        TEST_ASSERT_TRUE(db->get("d") == "4");
+    }
+}
+
+TEST_CASE("ConfigDbStore keeps names with the same hash apart", TAG)
+{
+    static_assert(settingHash("key583084") == settingHash("key1092000"), "a hash collision");
+    freshNvs();
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        dbMan.getWriteAccess()->set("key583084", "first");
+        dbMan.getWriteAccess()->set("key1092000", "second");
+        TEST_ASSERT_TRUE(store.flush());
+        dbMan.getWriteAccess()->set("key1092000", "second again");
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        TEST_ASSERT_TRUE(store.get("key583084") == std::string("first"));
+        TEST_ASSERT_TRUE(store.get("key1092000") == std::string("second again"));
+        dbMan.getWriteAccess()->erase("key583084"); // the first of the chain, the other one moves up
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        TEST_ASSERT_TRUE_MESSAGE(store.get("key1092000") == std::string("second again"), "Expected it found after the erase.");
+        TEST_ASSERT_FALSE(store.get("key583084").has_value());
+    }
+
+    MyConfigDbManager dbMan{};
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_TRUE(store.loadAll());
+    TEST_ASSERT_EQUAL(1, dbMan.getReadAccess()->settings.size());
+}
+
+TEST_CASE("ConfigDbStore rewrites all when the change records were forgotten", TAG)
+{
+    freshNvs();
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        dbMan.getWriteAccess()->set("a", "1");
+        dbMan.getWriteAccess()->set("b", "2");
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    {
+        MyConfigDbManager dbMan{};
+        ConfigDbStore store{dbMan, NVS_NS};
+        TEST_ASSERT_TRUE(store.loadAll());
+        if (auto db = dbMan.getWriteAccess())
+        {
+            db->set("a", "changed");
+            db->erase("b");
+            db->set("c", "3");
+            db->forgetChangesUpTo(db->revision()); // before the store saw them
+        }
+        TEST_ASSERT_TRUE(store.flush());
+    }
+
+    MyConfigDbManager dbMan{};
+    ConfigDbStore store{dbMan, NVS_NS};
+    TEST_ASSERT_TRUE(store.loadAll());
+    if (auto db = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL(2, db->settings.size());
+        TEST_ASSERT_TRUE(db->get("a") == "changed");
+        TEST_ASSERT_FALSE_MESSAGE(db->contains("b"), "Expected the erase written without its record.");
+        TEST_ASSERT_TRUE(db->get("c") == "3");
+    }
+}
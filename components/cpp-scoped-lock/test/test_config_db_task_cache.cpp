@@ -0,0 +1,123 @@
+/*
+  Unit tests for ConfigDbTaskCache, the per task cache of MyConfigDb values.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <string>
+
+#include "unity.h"
+
+#define TAG "[ConfigDbTaskCache]"
+
+#if CONFIG_SCOPED_LOCK_TASK_CACHE
+
+#include "ConfigDbTaskCache.hpp"
+
+static uint32_t readAttempts(const MyConfigDbManager &dbMan)
+{
+    return dbMan.getStats().read.attempts;
+}
+
+TEST_CASE("ConfigDbTaskCache hits take no lock", TAG)
+{
+    MyConfigDbManager dbMan{};
+    dbMan.getWriteAccess()->set("sensor.gain", "2.5");
+    dbMan.getWriteAccess()->set("loop.period", "3");
+    ConfigDbTaskCache cache{dbMan};
+    constexpr SettingKey gainKey{"sensor.gain"};
+    constexpr SettingKey periodKey{"loop.period"};
+
+    const uint32_t before = readAttempts(dbMan);
+    for (int i = 0; i < 100; i++)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(2.5f, cache.getFloat(gainKey).value_or(0));
+        TEST_ASSERT_EQUAL(3, cache.getInt(periodKey).value_or(0));
+        TEST_ASSERT_FALSE(cache.getBool("missing").has_value());
+    }
+    if (dbMan.getStats().enabled)
+    {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(before + 3, readAttempts(dbMan), "Expected one ReadAccess per key.");
+    }
+
+    dbMan.getWriteAccess()->set("sensor.gain", "4");
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, cache.getFloat(gainKey).value_or(0)); // refilled after the write
+    TEST_ASSERT_EQUAL(3, cache.getInt(periodKey).value_or(0));
+    TEST_ASSERT_EQUAL(4, cache.getInt(gainKey).value_or(0)); // another type of the same key
+    if (dbMan.getStats().enabled)
+    {
+        TEST_ASSERT_EQUAL_UINT32(before + 6, readAttempts(dbMan));
+    }
+
+    // the values of one cache don't show in another
+    MyConfigDbManager otherMan{};
+    otherMan.getWriteAccess()->set("sensor.gain", "9");
+    ConfigDbTaskCache otherCache{otherMan};
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, otherCache.getFloat(gainKey).value_or(0));
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, cache.getFloat(gainKey).value_or(0));
+
+    ConfigDbTaskCache::releaseTask();
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, cache.getFloat(gainKey).value_or(0));
+    ConfigDbTaskCache::releaseTask();
+}
+
+static MyConfigDbManager g_dbMan{};
+static ConfigDbTaskCache g_cache{g_dbMan};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static volatile int s_seenLast[2] = {};
+
+// like a control loop: reads every tick until stopped
+static void readerFunc(void *arg)
+{
+    const int id = (int)(intptr_t)arg;
+    while (!s_stop)
+    {
+        s_seenLast[id] = g_cache.getInt("counter").value_or(-1);
+        vTaskDelay(1);
+    }
+    s_seenLast[id] = g_cache.getInt("counter").value_or(-1);
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr); // frees the task's values
+}
+
+TEST_CASE("ConfigDbTaskCache values per task follow the writes", TAG)
+{
+    g_dbMan.getWriteAccess()->set("counter", "0");
+    s_stop = false;
+    s_done_semphr = xSemaphoreCreateCounting(2, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    for (int id = 0; id < 2; id++)
+    {
+        s_seenLast[id] = -1;
+        xTaskCreatePinnedToCore(readerFunc, "CacheReader", 4096, (void *)(intptr_t)id, ESP_TASK_MAIN_PRIO + 1, nullptr, id % portNUM_PROCESSORS);
+    }
+    for (int i = 1; i <= 20; i++)
+    {
+        g_dbMan.getWriteAccess()->set("counter", std::to_string(i));
+        vTaskDelay(2);
+    }
+    s_stop = true;
+    for (int k = 0; k < 2; k++)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(pdTRUE == xSemaphoreTake(s_done_semphr, pdMS_TO_TICKS(5000)), "Readers did not finish.");
+    }
+    vSemaphoreDelete(s_done_semphr);
+    TEST_ASSERT_EQUAL_MESSAGE(20, s_seenLast[0], "Expected the last write seen.");
+    TEST_ASSERT_EQUAL(20, s_seenLast[1]);
+}
+
+#else
+
+TEST_CASE("ConfigDbTaskCache", TAG)
+{
+    TEST_IGNORE_MESSAGE("CONFIG_SCOPED_LOCK_TASK_CACHE is disabled");
+}
+
+#endif // CONFIG_SCOPED_LOCK_TASK_CACHE
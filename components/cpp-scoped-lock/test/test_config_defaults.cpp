@@ -0,0 +1,105 @@
+/*
+  Unit tests for the read-only defaults layer of MyConfigDb (MyConfigDb::setDefaults()).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include <string>
+#include <vector>
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[ConfigDefaults]"
+
+// stands in for the mapped factory partition
+static std::vector<uint8_t> makeDefaults(int n)
+{
+    MyConfigDb factory{};
+    for (int i = 0; i < n; i++)
+    {
+        factory.set("default." + std::to_string(i), std::to_string(i));
+    }
+    factory.set("wifi.mode", "station");
+    std::vector<uint8_t> blob;
+    factory.serialize(blob, true, true);
+    return blob;
+}
+
+TEST_CASE("Defaults layer under the settings", TAG)
+{
+    const std::vector<uint8_t> blob = makeDefaults(200);
+    MyConfigDbManager dbMan{};
+    if (auto db = dbMan.getWriteAccess())
+    {
+        db->setDefaults(ConfigBlobView(blob.data(), blob.size()));
+        TEST_ASSERT_TRUE(db->defaults().valid());
+    }
+
+    if (auto db = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL_MESSAGE(0, db->settings.size(), "Nothing is copied into the settings.");
+        TEST_ASSERT_TRUE(db->get("wifi.mode") == "station");
+        TEST_ASSERT_EQUAL(123, db->getInt("default.123").value_or(-1));
+        TEST_ASSERT_TRUE(db->contains("default.199"));
+        TEST_ASSERT_FALSE(db->contains("default.200"));
+    }
+
+    if (auto db = dbMan.getWriteAccess())
+    {
+        db->set("wifi.mode", "ap");
+        db->set("new.key", "1");
+        db->set("default.5", "5"); // the default value, no override needed
+        TEST_ASSERT_EQUAL(2, db->settings.size());
+        TEST_ASSERT_TRUE(db->get("wifi.mode") == "ap");
+
+        int count = 0;
+        db->forEachSetting([&count](SettingKey key, std::string_view value) {
+            if (key.name == "wifi.mode")
+            {
+                TEST_ASSERT_TRUE(value == "ap");
+            }
+            count++;
+        });
+        TEST_ASSERT_EQUAL(202, count);
+
+        TEST_ASSERT_TRUE(db->erase("wifi.mode"));
+        TEST_ASSERT_TRUE_MESSAGE(db->get("wifi.mode") == "station", "Expected the default after erasing the override.");
+        TEST_ASSERT_FALSE_MESSAGE(db->erase("wifi.mode"), "Defaults can't be erased.");
+        db->set("new.key", "2");
+        db->set("wifi.mode", "ap");
+        db->set("wifi.mode", "station"); // back to the default drops the override
+        TEST_ASSERT_EQUAL(1, db->settings.size());
+    }
+}
+
+TEST_CASE("Indexed and plain blobs find the same values", TAG)
+{
+    MyConfigDb db{};
+    for (int i = 0; i < 300; i++)
+    {
+        db.set("key" + std::to_string(i), "value" + std::to_string(i % 17));
+    }
+    std::vector<uint8_t> plain, indexed;
+    db.serialize(plain);
+    db.serialize(indexed, true, true);
+    ConfigBlobView plainView{plain.data(), plain.size()};
+    ConfigBlobView indexedView{indexed.data(), indexed.size()};
+    TEST_ASSERT_TRUE(plainView.valid());
+    TEST_ASSERT_TRUE(indexedView.valid());
+    ESP_LOGI(TAG, "300 settings: %u bytes, %u with index", (unsigned)plain.size(), (unsigned)indexed.size());
+
+    for (int i = 0; i < 310; i++)
+    {
+        const std::string name = "key" + std::to_string(i);
+        TEST_ASSERT_TRUE(plainView.find(name) == indexedView.find(name));
+        TEST_ASSERT_TRUE(indexedView.find(name) == db.get(name));
+    }
+
+    // load() ignores the index
+    MyConfigDb loaded{};
+    TEST_ASSERT_TRUE(loaded.load(indexedView));
+    TEST_ASSERT_EQUAL(300, loaded.settings.size());
+}
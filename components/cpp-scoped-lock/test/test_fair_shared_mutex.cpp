@@ -0,0 +1,134 @@
+/*
+  Unit tests for the FairSharedMutex policies of LockableObject.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "FairSharedMutex.hpp"
+
+#define TAG "[FairSharedMutex]"
+
+template <class mutexType>
+static void checkBasicLocking()
+{
+    LockableObject<MyConfigDb, mutexType> dbMan{};
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        auto readLock2 = dbMan.getReadAccess();
+        TEST_ASSERT_TRUE_MESSAGE(bool(readLock2), "Expect to get second read lock.");
+        auto writeLock = dbMan.getWriteAccess(std::chrono::milliseconds(20));
+        TEST_ASSERT_FALSE_MESSAGE(bool(writeLock), "Should not get write lock while read.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get read lock.");
+    }
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        auto readLock = dbMan.getReadAccess();
+        TEST_ASSERT_FALSE_MESSAGE(bool(readLock), "Should not get read lock while write.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get write lock.");
+    }
+
+    auto readLock = dbMan.getReadAccess();
+    TEST_ASSERT_TRUE_MESSAGE(bool(readLock), "Expect to get read lock after release write lock.");
+}
+
+TEST_CASE("FairSharedMutex locking, all policies", TAG)
+{
+    checkBasicLocking<ReaderPreferringSharedMutex>();
+    checkBasicLocking<WriterPreferringSharedMutex>();
+    checkBasicLocking<PhaseFairSharedMutex>();
+}
+
+// Readers overlap their read sections so that the lock is never free of readers.
+// A reader-preferring lock would starve the writer; phase-fair and writer-preferring must not.
+using PhaseFairDbManager = LockableObject<MyConfigDb, PhaseFairSharedMutex>;
+static PhaseFairDbManager g_PhaseFairDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static volatile int s_reads = 0;
+static volatile int s_read_failures = 0;
+
+static void overlappingReaderFunc(void *arg)
+{
+    const int delayTicks = (int)(intptr_t)arg;
+    xSemaphoreGive(s_done_semphr);
+    while (!s_stop)
+    {
+        if (auto dbAccess = g_PhaseFairDbManager.getReadAccess(std::chrono::milliseconds(500)))
+        {
+            s_reads = s_reads + 1;
+            vTaskDelay(delayTicks); // hold the read lock for a while
+        }
+        else
+        {
+            s_read_failures = s_read_failures + 1;
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("PhaseFair writer latency is bounded under continuous readers", TAG)
+{
+    const int NUM_READERS = 6;
+    const int64_t READ_HOLD_MS = 2 * portTICK_PERIOD_MS;
+    s_stop = false;
+    s_reads = 0;
+    s_read_failures = 0;
+    s_done_semphr = xSemaphoreCreateCounting(NUM_READERS, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+
+    for (int i = 0; i < NUM_READERS; i++)
+    {
+        xTaskCreatePinnedToCore(overlappingReaderFunc, "PfReader", 2048, (void *)(intptr_t)(1 + i % 2),
+                                ESP_TASK_MAIN_PRIO + 1, nullptr, i % portNUM_PROCESSORS);
+    }
+    for (int k = 0; k < NUM_READERS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+
+    int64_t worstWaitUs = 0;
+    int writes = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        const int64_t start = esp_timer_get_time();
+        if (auto dbAccess = g_PhaseFairDbManager.getWriteAccess(std::chrono::milliseconds(1000)))
+        {
+            writes++;
+        }
+        const int64_t waited = esp_timer_get_time() - start;
+        worstWaitUs = waited > worstWaitUs ? waited : worstWaitUs;
+        vTaskDelay(1);
+    }
+
+    s_stop = true;
+    for (int k = 0; k < NUM_READERS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    ESP_LOGI(TAG, "PhaseFair: %d writes, worst writer wait %lld us, %d reads, %d read failures",
+             writes, (long long)worstWaitUs, s_reads, s_read_failures);
+    TEST_ASSERT_EQUAL_MESSAGE(50, writes, "Writer must not be starved.");
+    // one reader phase plus scheduling slack
+    TEST_ASSERT_LESS_THAN_MESSAGE((READ_HOLD_MS + 3 * portTICK_PERIOD_MS) * 1000, worstWaitUs, "Writer wait exceeds the phase-fair bound.");
+    TEST_ASSERT_EQUAL_MESSAGE(0, s_read_failures, "Readers must keep running.");
+}
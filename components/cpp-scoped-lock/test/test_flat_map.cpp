@@ -0,0 +1,71 @@
+/*
+  Unit tests for FlatMap, the settings container of MyConfigDb.
+*/
+
+#include <string>
+
+#include "unity.h"
+#include "FlatMap.hpp"
+#include "MyConfigDb.hpp"
+
+#define TAG "[FlatMap]"
+
+TEST_CASE("FlatMap map-like API", TAG)
+{
+    FlatMap<std::string, std::string> map;
+    TEST_ASSERT_TRUE(map.empty());
+
+    map["b"] = "2";
+    map["a"] = "1";
+    TEST_ASSERT_TRUE(map.insert({"c", "3"}).second);
+    TEST_ASSERT_FALSE_MESSAGE(map.insert({"c", "x"}).second, "Insert must not overwrite.");
+    map.insert_or_assign("c", std::string("3b"));
+    TEST_ASSERT_TRUE(map.emplace("d", "4").second);
+    TEST_ASSERT_EQUAL(4, map.size());
+
+    // iteration is in key order
+    std::string keys;
+    for (const auto &[key, value] : map)
+    {
+        keys += key;
+    }
+    TEST_ASSERT_EQUAL_STRING("abcd", keys.c_str());
+
+    TEST_ASSERT_TRUE(map.find("a") != map.end());
+    TEST_ASSERT_TRUE(map.find("zz") == map.end());
+    TEST_ASSERT_EQUAL_STRING("3b", map.at("c").c_str());
+    TEST_ASSERT_EQUAL(1, map.count("b"));
+    TEST_ASSERT_TRUE(map.contains("d"));
+
+    TEST_ASSERT_EQUAL(1, map.erase("b"));
+    TEST_ASSERT_EQUAL(0, map.erase("b"));
+    TEST_ASSERT_FALSE(map.contains("b"));
+    TEST_ASSERT_EQUAL(3, map.size());
+
+    const auto capacity = map.capacity();
+    map.clear();
+    TEST_ASSERT_TRUE(map.empty());
+    TEST_ASSERT_EQUAL_MESSAGE(capacity, map.capacity(), "clear() should keep the allocated block.");
+}
+
+TEST_CASE("MyConfigDb settings keep the map API", TAG)
+{
+    MyConfigDbManager dbMan{};
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        dbAccess->settings["brightness"] = "80";
+        dbAccess->settings.emplace("mode", "auto");
+    }
+    if (auto dbAccess = dbMan.getReadAccess())
+    {
+        auto it = dbAccess->settings.find("brightness");
+        TEST_ASSERT_TRUE(it != dbAccess->settings.end());
+        TEST_ASSERT_EQUAL_STRING("80", it->second.c_str());
+        TEST_ASSERT_EQUAL(2, dbAccess->settings.size());
+    }
+    dbMan.reset();
+    if (auto dbAccess = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_TRUE(dbAccess->settings.empty());
+    }
+}
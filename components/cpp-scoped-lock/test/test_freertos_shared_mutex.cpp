@@ -0,0 +1,139 @@
+/*
+  Unit tests for the FreeRtosSharedMutex policy of LockableObject.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "FreeRtosSharedMutex.hpp"
+
+#define TAG "[FreeRtosSharedMutex]"
+
+using FreeRtosDbManager = LockableObject<MyConfigDb, FreeRtosSharedMutex>;
+
+TEST_CASE("FreeRtosSharedMutex locking", TAG)
+{
+    FreeRtosDbManager dbMan{};
+
+    bool gotReadLock = false;
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        gotReadLock = true;
+        // a second reader must not block
+        auto readLock2 = dbMan.getReadAccess();
+        TEST_ASSERT_TRUE_MESSAGE(bool(readLock2), "Expect to get second read lock.");
+        // a writer must not get in while readers are active
+        auto writeLock = dbMan.getWriteAccess(FreeRtosDbManager::minBlockTime);
+        TEST_ASSERT_FALSE_MESSAGE(bool(writeLock), "Should not get write lock while read.");
+    }
+    TEST_ASSERT_TRUE_MESSAGE(gotReadLock, "Expect to get read lock.");
+
+    bool gotWriteLock = false;
+    bool gotReadWhileWriteLock = false;
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        gotWriteLock = true;
+        if (auto readLock = dbMan.getReadAccess())
+        {
+            gotReadWhileWriteLock = true;
+        }
+    }
+    TEST_ASSERT_TRUE_MESSAGE(gotWriteLock, "Expect to get write lock.");
+    TEST_ASSERT_FALSE_MESSAGE(gotReadWhileWriteLock, "Should not get read lock while write.");
+
+    gotReadLock = false;
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        gotReadLock = true;
+    }
+    TEST_ASSERT_TRUE_MESSAGE(gotReadLock, "Expect to get read lock after release write lock.");
+}
+
+static FreeRtosDbManager g_FreeRtosDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static volatile int s_reads = 0;
+static volatile int s_read_failures = 0;
+static volatile int s_writes = 0;
+
+static void freeRtosMixedFunc(void *arg)
+{
+    const int threadIndex = (int)(intptr_t)arg;
+    const bool isWriter = (threadIndex % 4 == 0);
+    xSemaphoreGive(s_done_semphr);
+    while (!s_stop)
+    {
+        if (isWriter)
+        {
+            if (auto dbAccess = g_FreeRtosDbManager.getWriteAccess())
+            {
+                dbAccess->settings["writer"] = "x";
+                s_writes = s_writes + 1;
+            }
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+        else
+        {
+            // writers hold the lock for far less than a tick, so a reader should never time out
+            if (auto dbAccess = g_FreeRtosDbManager.getReadAccess(std::chrono::milliseconds(100)))
+            {
+                s_reads = s_reads + 1;
+            }
+            else
+            {
+                s_read_failures = s_read_failures + 1;
+                ESP_LOGE(TAG, "Thread %d failed to get read lock.", threadIndex);
+            }
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("FreeRtosSharedMutex mixed read/write stress test", TAG)
+{
+    const int NUM_TASKS = 12;
+    s_stop = false;
+    s_reads = 0;
+    s_read_failures = 0;
+    s_writes = 0;
+    s_done_semphr = xSemaphoreCreateCounting(NUM_TASKS, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+
+    for (int i = 0; i < NUM_TASKS; i++)
+    {
+        xTaskCreatePinnedToCore(freeRtosMixedFunc,
+                                "FrMixedTask",
+                                2048,
+                                (void *)(intptr_t)i,
+                                ESP_TASK_MAIN_PRIO + 1 + (i % 4),
+                                nullptr,
+                                i % portNUM_PROCESSORS);
+    }
+    for (int k = 0; k < NUM_TASKS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(5000));
+
+    s_stop = true;
+    for (int k = 0; k < NUM_TASKS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    ESP_LOGI(TAG, "FreeRtosSharedMutex mixed test: %d reads, %d read failures, %d writes", s_reads, s_read_failures, s_writes);
+    TEST_ASSERT_EQUAL_MESSAGE(0, s_read_failures, "Expected no read locks to fail.");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, s_writes, "Expected some write locks to be acquired.");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(100, s_reads, "Expected substantial read lock acquisitions.");
+}
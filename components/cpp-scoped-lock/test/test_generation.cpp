@@ -0,0 +1,77 @@
+/*
+  Unit tests for the lock-free write generation counters.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "SeqLockableObject.hpp"
+
+#define TAG "[generation]"
+
+TEST_CASE("generation counts writes, not reads", TAG)
+{
+    MyConfigDbManager dbMan{};
+    const uint32_t start = dbMan.generation();
+    TEST_ASSERT_NOT_EQUAL(MyConfigDbManager::noGeneration, start);
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        (void)readLock->get("a");
+    }
+    TEST_ASSERT_EQUAL_UINT32(start, dbMan.generation());
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        writeLock->set("a", "1");
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(start, dbMan.generation(), "Bumped when the write ends.");
+    }
+    TEST_ASSERT_EQUAL_UINT32(start + 1, dbMan.generation());
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        auto writeLock = dbMan.getWriteAccess(MyConfigDbManager::minBlockTime);
+        TEST_ASSERT_FALSE(bool(writeLock));
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(start + 1, dbMan.generation(), "A timed out write must not count.");
+
+    dbMan.postWrite([](MyConfigDb &db) { db.set("b", "2"); });
+    TEST_ASSERT_EQUAL_UINT32(start + 2, dbMan.generation());
+}
+
+TEST_CASE("readIfChanged skips unchanged objects", TAG)
+{
+    MyConfigDbManager dbMan{};
+    dbMan.getWriteAccess()->set("threshold", "5");
+
+    uint32_t seen = MyConfigDbManager::noGeneration;
+    int cached = 0;
+    int reads = 0;
+    auto refresh = [&](const MyConfigDb &db) {
+        cached = db.getInt("threshold").value_or(0);
+        reads++;
+    };
+
+    TEST_ASSERT_TRUE(dbMan.readIfChanged(seen, refresh));
+    TEST_ASSERT_EQUAL(5, cached);
+    TEST_ASSERT_FALSE(dbMan.readIfChanged(seen, refresh));
+    TEST_ASSERT_FALSE(dbMan.readIfChanged(seen, refresh));
+    TEST_ASSERT_EQUAL(1, reads);
+
+    dbMan.getWriteAccess()->set("threshold", "7");
+    TEST_ASSERT_TRUE(dbMan.readIfChanged(seen, refresh));
+    TEST_ASSERT_EQUAL(7, cached);
+    TEST_ASSERT_EQUAL(2, reads);
+}
+
+TEST_CASE("SeqLockableObject generation", TAG)
+{
+    SeqLockableObject<uint32_t> value{};
+    const uint32_t start = value.generation();
+    value.write(1);
+    value.write(2);
+    TEST_ASSERT_EQUAL_UINT32(start + 2, value.generation());
+}
@@ -0,0 +1,87 @@
+/*
+  Unit tests for the LockableObject contention statistics (CONFIG_SCOPED_LOCK_STATS).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[LockStats]"
+
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_read_acquired = false;
+
+// Try to read from another task: a pthread rwlock may fail right away (EDEADLK) when the same thread holds it for writing
+static void timedOutReaderFunc(void *arg)
+{
+    MyConfigDbManager &dbMan = *static_cast<MyConfigDbManager *>(arg);
+    {
+        auto readLock = dbMan.getReadAccess(); // times out after minBlockTime
+        s_read_acquired = bool(readLock);
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("LockStats counts attempts and timeouts", TAG)
+{
+    MyConfigDbManager dbMan{};
+    dbMan.clearStats();
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        writeLock->settings["key"] = "value";
+        s_done_semphr = xSemaphoreCreateBinary();
+        xTaskCreate(timedOutReaderFunc, "StatsReader", 2048, &dbMan, uxTaskPriorityGet(nullptr), nullptr);
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+        vSemaphoreDelete(s_done_semphr);
+        TEST_ASSERT_FALSE(bool(s_read_acquired));
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        auto readLock = dbMan.getReadAccess();
+        TEST_ASSERT_TRUE(bool(readLock));
+    }
+
+    const LockStatsSnapshot stats = dbMan.getStats();
+    logLockStats(TAG, "dbMan", stats);
+#if CONFIG_SCOPED_LOCK_STATS
+    TEST_ASSERT_TRUE(stats.enabled);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.write.attempts);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.write.acquired);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.write.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.read.attempts);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.read.acquired);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.read.timeouts);
+    // the timed out read waited at least minBlockTime: it lands in the 10ms..100ms bucket
+    TEST_ASSERT_EQUAL_UINT32(1, stats.read.waitHistogram[4]);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(9000, stats.read.maxWaitUs);
+    // the write lock was held for the duration of the read timeout
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(9000, stats.write.maxHoldUs);
+    TEST_ASSERT_NULL(stats.writer);
+
+    dbMan.clearStats();
+    TEST_ASSERT_EQUAL_UINT32(0, dbMan.getStats().read.attempts);
+#else
+    TEST_ASSERT_FALSE(stats.enabled);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.read.attempts);
+#endif
+}
+
+TEST_CASE("LockStats reports the writer task", TAG)
+{
+    MyConfigDbManager dbMan{};
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+#if CONFIG_SCOPED_LOCK_STATS
+        TEST_ASSERT_EQUAL_PTR(xTaskGetCurrentTaskHandle(), dbMan.getStats().writer);
+#endif
+    }
+    TEST_ASSERT_NULL(dbMan.getStats().writer);
+}
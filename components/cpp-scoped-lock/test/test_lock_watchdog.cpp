@@ -0,0 +1,55 @@
+/*
+  Unit tests for the LockableObject hold-time watchdog (CONFIG_SCOPED_LOCK_WATCHDOG).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "LockWatchdog.hpp"
+
+#define TAG "[LockWatchdog]"
+
+static LockHoldReport s_lastReport{};
+static int s_reports = 0;
+
+static void captureReport(const LockHoldReport &report)
+{
+    s_lastReport = report;
+    s_reports++;
+}
+
+TEST_CASE("LockWatchdog reports a long hold once", TAG)
+{
+#if CONFIG_SCOPED_LOCK_WATCHDOG
+    MyConfigDbManager dbMan{};
+    LockWatchdog::setHandler(captureReport);
+    s_reports = 0;
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL(0, LockWatchdog::check(50)); // just acquired
+    }
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        TEST_ASSERT_EQUAL(1, LockWatchdog::check(50));
+        TEST_ASSERT_EQUAL_PTR(&dbMan, s_lastReport.object);
+        TEST_ASSERT_EQUAL_PTR(xTaskGetCurrentTaskHandle(), s_lastReport.task);
+        TEST_ASSERT_TRUE(s_lastReport.write);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(90, s_lastReport.heldMs);
+        TEST_ASSERT_EQUAL(0, LockWatchdog::check(50)); // the same hold is reported only once
+    }
+    TEST_ASSERT_EQUAL(0, LockWatchdog::check(50)); // released
+    TEST_ASSERT_EQUAL(1, s_reports);
+
+    LockWatchdog::setHandler(nullptr);
+#else
+    TEST_IGNORE_MESSAGE("CONFIG_SCOPED_LOCK_WATCHDOG is disabled");
+#endif
+}
@@ -0,0 +1,103 @@
+/*
+  Unit tests for lockAll() (MultiLock.hpp).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "MultiLock.hpp"
+#include "SeqLockableObject.hpp"
+
+#define TAG "[MultiLock]"
+
+struct Counter
+{
+    int value;
+};
+
+TEST_CASE("lockAll locks and releases all objects together", TAG)
+{
+    MyConfigDbManager dbA{};
+    MyConfigDbManager dbB{};
+    SeqLockableObject<Counter> counter{};
+
+    if (auto all = lockAll(dbA, dbB, counter, std::chrono::milliseconds(100)))
+    {
+        all.get<0>()->settings["a"] = "1";
+        all.get<1>()->settings["b"] = "2";
+        all.get<2>()->value = 3;
+        TEST_ASSERT_FALSE_MESSAGE(bool(dbA.getReadAccess()), "Should not get read lock while locked by lockAll.");
+        TEST_ASSERT_FALSE_MESSAGE(bool(dbB.getReadAccess()), "Should not get read lock while locked by lockAll.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get all locks.");
+    }
+
+    TEST_ASSERT_EQUAL_STRING("1", dbA.getReadAccess()->settings.at("a").c_str());
+    TEST_ASSERT_EQUAL_STRING("2", dbB.getReadAccess()->settings.at("b").c_str());
+    TEST_ASSERT_EQUAL(3, counter.read().value);
+}
+
+TEST_CASE("lockAll times out without keeping partial locks", TAG)
+{
+    MyConfigDbManager dbA{};
+    MyConfigDbManager dbB{};
+
+    if (auto writeB = dbB.getWriteAccess())
+    {
+        auto all = lockAll(dbA, dbB, std::chrono::milliseconds(50));
+        TEST_ASSERT_FALSE_MESSAGE(bool(all), "Should not get all locks while one is held.");
+        // dbA must not stay locked by the failed attempt
+        TEST_ASSERT_TRUE_MESSAGE(bool(dbA.getWriteAccess(MyConfigDbManager::minBlockTime)), "Expect dbA to be released.");
+    }
+}
+
+static MyConfigDbManager g_dbA{};
+static MyConfigDbManager g_dbB{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile int s_transactions[2] = {};
+
+// Each task passes the objects in a different order. Nesting getWriteAccess() like this by hand would deadlock.
+static void transactionFunc(void *arg)
+{
+    const int id = (int)(intptr_t)arg;
+    for (int i = 0; i < 200; i++)
+    {
+        auto all = (id == 0) ? lockAll(g_dbA, g_dbB, std::chrono::milliseconds(1000)) : lockAll(g_dbB, g_dbA, std::chrono::milliseconds(1000));
+        if (all)
+        {
+            s_transactions[id] = s_transactions[id] + 1;
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("lockAll in opposite argument order does not deadlock", TAG)
+{
+    s_done_semphr = xSemaphoreCreateCounting(2, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    for (int id = 0; id < 2; id++)
+    {
+        s_transactions[id] = 0;
+        xTaskCreatePinnedToCore(transactionFunc, "Transaction", 4096, (void *)(intptr_t)id, ESP_TASK_MAIN_PRIO + 1, nullptr, id % portNUM_PROCESSORS);
+    }
+    for (int k = 0; k < 2; k++)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(pdTRUE == xSemaphoreTake(s_done_semphr, pdMS_TO_TICKS(20000)), "Transactions did not finish.");
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    ESP_LOGI(TAG, "transactions: %d / %d", s_transactions[0], s_transactions[1]);
+    TEST_ASSERT_EQUAL(200, s_transactions[0]);
+    TEST_ASSERT_EQUAL(200, s_transactions[1]);
+}
@@ -0,0 +1,145 @@
+/*
+  Unit tests for the PerCoreSharedMutex (big-reader lock) policy of LockableObject.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "PerCoreSharedMutex.hpp"
+
+#define TAG "[PerCoreSharedMutex]"
+
+using PerCoreDbManager = LockableObject<MyConfigDb, PerCoreSharedMutex>;
+
+TEST_CASE("PerCoreSharedMutex locking", TAG)
+{
+    PerCoreDbManager dbMan{};
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        auto readLock2 = dbMan.getReadAccess();
+        TEST_ASSERT_TRUE_MESSAGE(bool(readLock2), "Expect to get second read lock.");
+        auto writeLock = dbMan.getWriteAccess(PerCoreDbManager::minBlockTime);
+        TEST_ASSERT_FALSE_MESSAGE(bool(writeLock), "Should not get write lock while read.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get read lock.");
+    }
+
+    bool gotReadWhileWriteLock = false;
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        writeLock->settings["key"] = "value";
+        if (auto readLock = dbMan.getReadAccess())
+        {
+            gotReadWhileWriteLock = true;
+        }
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get write lock.");
+    }
+    TEST_ASSERT_FALSE_MESSAGE(gotReadWhileWriteLock, "Should not get read lock while write.");
+
+    auto readLock = dbMan.getReadAccess();
+    TEST_ASSERT_TRUE_MESSAGE(bool(readLock), "Expect to get read lock after release write lock.");
+    TEST_ASSERT_EQUAL_STRING("value", readLock->settings.at("key").c_str());
+}
+
+static PerCoreDbManager g_PerCoreDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static volatile int s_read_failures = 0;
+static volatile int s_writes = 0;
+static volatile int s_reads[portNUM_PROCESSORS] = {};
+
+static void perCoreReaderFunc(void *arg)
+{
+    const int core = (int)(intptr_t)arg;
+    xSemaphoreGive(s_done_semphr);
+    int i = 0;
+    while (!s_stop)
+    {
+        if (auto dbAccess = g_PerCoreDbManager.getReadAccess(std::chrono::milliseconds(100)))
+        {
+            s_reads[core] = s_reads[core] + 1;
+        }
+        else
+        {
+            s_read_failures = s_read_failures + 1;
+        }
+        if (++i % 32 == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+static void perCoreWriterFunc(void *arg)
+{
+    xSemaphoreGive(s_done_semphr);
+    while (!s_stop)
+    {
+        if (auto dbAccess = g_PerCoreDbManager.getWriteAccess())
+        {
+            s_writes = s_writes + 1;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("PerCoreSharedMutex readers on all cores with a writer", TAG)
+{
+    const int READERS_PER_CORE = 3;
+    const int NUM_TASKS = READERS_PER_CORE * portNUM_PROCESSORS + 1;
+    s_stop = false;
+    s_read_failures = 0;
+    s_writes = 0;
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+    {
+        s_reads[c] = 0;
+    }
+    s_done_semphr = xSemaphoreCreateCounting(NUM_TASKS, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+
+    for (int i = 0; i < READERS_PER_CORE * portNUM_PROCESSORS; i++)
+    {
+        const int core = i % portNUM_PROCESSORS;
+        xTaskCreatePinnedToCore(perCoreReaderFunc, "PcReader", 2048, (void *)(intptr_t)core, ESP_TASK_MAIN_PRIO + 1, nullptr, core);
+    }
+    xTaskCreatePinnedToCore(perCoreWriterFunc, "PcWriter", 2048, nullptr, ESP_TASK_MAIN_PRIO + 2, nullptr, 0);
+    for (int k = 0; k < NUM_TASKS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(3000));
+
+    s_stop = true;
+    for (int k = 0; k < NUM_TASKS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+    {
+        ESP_LOGI(TAG, "core %d: %d reads", c, s_reads[c]);
+        TEST_ASSERT_GREATER_THAN_MESSAGE(100, s_reads[c], "Expected readers to make progress on every core.");
+    }
+    ESP_LOGI(TAG, "%d writes, %d read failures", s_writes, s_read_failures);
+    TEST_ASSERT_EQUAL_MESSAGE(0, s_read_failures, "Expected no read locks to fail.");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, s_writes, "Expected some write locks to be acquired.");
+}
@@ -0,0 +1,129 @@
+/*
+  Unit tests for LockableObject::postWrite() (queued, batched updates).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[postWrite]"
+
+TEST_CASE("postWrite applies now or when the lock is released", TAG)
+{
+    MyConfigDbManager dbMan{};
+
+    dbMan.postWrite([](MyConfigDb &db) { db.set("free", "1"); });
+    TEST_ASSERT_FALSE_MESSAGE(dbMan.hasPendingWrites(), "Expect to apply at once when the lock is free.");
+    TEST_ASSERT_TRUE(dbMan.getReadAccess()->contains("free"));
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        dbMan.postWrite([](MyConfigDb &db) { db.set("afterRead", "1"); });
+        TEST_ASSERT_TRUE_MESSAGE(dbMan.hasPendingWrites(), "Expect to queue while read.");
+        TEST_ASSERT_FALSE(readLock->contains("afterRead"));
+    }
+    TEST_ASSERT_FALSE_MESSAGE(dbMan.hasPendingWrites(), "Expect the reader to apply the queue on release.");
+    TEST_ASSERT_TRUE(dbMan.getReadAccess()->contains("afterRead"));
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        dbMan.postWrite([](MyConfigDb &db) { db.set("order", "first"); });
+        dbMan.postWrite([](MyConfigDb &db) { db.set("order", "second"); });
+        writeLock->set("order", "writer");
+        TEST_ASSERT_TRUE(dbMan.hasPendingWrites());
+    }
+    // applied in posting order, after the writer's own change, before anyone else got the lock
+    TEST_ASSERT_FALSE(dbMan.hasPendingWrites());
+    TEST_ASSERT_TRUE(dbMan.getReadAccess()->get("order") == std::string_view("second"));
+}
+
+TEST_CASE("postWrite batches count in the lock statistics", TAG)
+{
+    MyConfigDbManager dbMan{};
+
+    dbMan.postWrite([](MyConfigDb &db) { db.set("free", "1"); });
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        dbMan.postWrite([](MyConfigDb &db) { db.set("afterRead", "1"); });
+        dbMan.postWrite([](MyConfigDb &db) { db.set("afterRead", "2"); });
+    }
+    TEST_ASSERT_FALSE(dbMan.hasPendingWrites());
+
+    const LockStatsSnapshot stats = dbMan.getStats();
+#if CONFIG_SCOPED_LOCK_STATS
+    TEST_ASSERT_TRUE(stats.enabled);
+    // one write for the update applied at once, one for the batch the reader left behind
+    TEST_ASSERT_EQUAL_UINT32(2, stats.write.attempts);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.write.acquired);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.write.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.read.acquired);
+    TEST_ASSERT_NULL(stats.writer);
+#else
+    TEST_ASSERT_FALSE(stats.enabled);
+#endif
+}
+
+static MyConfigDbManager g_PostDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static const int POSTS_PER_TASK = 100;
+
+static void posterFunc(void *arg)
+{
+    for (int i = 0; i < POSTS_PER_TASK; i++)
+    {
+        g_PostDbManager.postWrite([](MyConfigDb &db) { db.set("count", std::to_string(db.getInt("count").value_or(0) + 1)); });
+        if (i % 8 == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+// keeps the lock busy, so most updates get queued and applied in batches
+static void postReaderFunc(void *arg)
+{
+    while (!s_stop)
+    {
+        if (auto readLock = g_PostDbManager.getReadAccess())
+        {
+            (void)readLock->getInt("count");
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("postWrite from several tasks with readers", TAG)
+{
+    const int NUM_POSTERS = 4;
+    g_PostDbManager.reset();
+    s_stop = false;
+    s_done_semphr = xSemaphoreCreateCounting(NUM_POSTERS + 1, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    xTaskCreatePinnedToCore(postReaderFunc, "PostReader", 4096, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, 1 % portNUM_PROCESSORS);
+    for (int i = 0; i < NUM_POSTERS; i++)
+    {
+        xTaskCreatePinnedToCore(posterFunc, "Poster", 4096, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, i % portNUM_PROCESSORS);
+    }
+    for (int k = 0; k < NUM_POSTERS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+    s_stop = true;
+    xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    vSemaphoreDelete(s_done_semphr);
+
+    TEST_ASSERT_TRUE(g_PostDbManager.applyPendingWrites());
+    TEST_ASSERT_FALSE(g_PostDbManager.hasPendingWrites());
+    TEST_ASSERT_EQUAL(NUM_POSTERS * POSTS_PER_TASK, g_PostDbManager.getReadAccess()->getInt("count").value_or(0));
+}
@@ -0,0 +1,98 @@
+/*
+  Unit tests for LockableObject::reset(), exchange() and clear() (short write sections for whole-object changes).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[reset]"
+
+struct Tracked;
+static LockableObject<Tracked> *s_owner = nullptr;
+static uint32_t s_generationAtDestroy = 0;
+
+struct Tracked
+{
+    std::map<int, std::string> data;
+
+    ~Tracked()
+    {
+        if (!data.empty() && s_owner)
+        {
+            s_generationAtDestroy = s_owner->generation();
+        }
+    }
+};
+
+TEST_CASE("reset destroys the old object after the write section", TAG)
+{
+    LockableObject<Tracked> tracked{};
+    s_owner = &tracked;
+    for (int i = 0; i < 100; i++)
+    {
+        tracked.getWriteAccess()->data[i] = "value";
+    }
+    const uint32_t generation = tracked.generation();
+    tracked.reset();
+    // the write section ends with bumping the generation, so the old object was destroyed after it
+    TEST_ASSERT_EQUAL_UINT32(generation + 1, s_generationAtDestroy);
+    TEST_ASSERT_TRUE(tracked.getReadAccess()->data.empty());
+
+    tracked.getWriteAccess()->data[1] = "one";
+    Tracked old = tracked.exchange(Tracked{});
+    TEST_ASSERT_EQUAL(1, old.data.size());
+    TEST_ASSERT_TRUE(tracked.getReadAccess()->data.empty());
+    s_owner = nullptr;
+}
+
+TEST_CASE("clear keeps the capacity and counts as erases", TAG)
+{
+    MyConfigDb factory{};
+    factory.set("wifi.mode", "station");
+    std::vector<uint8_t> defaults;
+    factory.serialize(defaults, true, true);
+
+    MyConfigDbManager dbMan{};
+    if (auto db = dbMan.getWriteAccess())
+    {
+        db->setDefaults(ConfigBlobView(defaults.data(), defaults.size()));
+        for (int i = 0; i < 50; i++)
+        {
+            db->set("key" + std::to_string(i), "value");
+        }
+    }
+    const std::size_t capacity = dbMan.getReadAccess()->settings.capacity();
+    const uint32_t revision = dbMan.getReadAccess()->revision();
+
+    dbMan.clear();
+    if (auto db = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_TRUE(db->settings.empty());
+        TEST_ASSERT_EQUAL_MESSAGE(capacity, db->settings.capacity(), "Expected the capacity kept for the refill.");
+        TEST_ASSERT_TRUE_MESSAGE(db->get("wifi.mode") == "station", "Expected the defaults kept.");
+        int erased = 0;
+        db->forEachChangedSince(revision, [&erased](SettingKey, std::optional<std::string_view> value) {
+            erased += value ? 0 : 1;
+        });
+        TEST_ASSERT_EQUAL(50, erased);
+    }
+
+    dbMan.getWriteAccess()->set("key0", "value");
+    const uint32_t beforeReset = dbMan.getReadAccess()->revision();
+    dbMan.reset();
+    if (auto db = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL_MESSAGE(0, db->settings.capacity(), "reset() starts over.");
+        TEST_ASSERT_TRUE_MESSAGE(db->get("wifi.mode") == "station", "Expected the defaults kept by reset().");
+        TEST_ASSERT_TRUE_MESSAGE(db->revision() > beforeReset, "Expected the revision to go on.");
+        TEST_ASSERT_EQUAL_UINT32(db->revision(), db->changedAt("key0"));
+    }
+}
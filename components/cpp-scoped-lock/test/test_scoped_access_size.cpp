@@ -0,0 +1,55 @@
+/*
+  Unit tests for the footprint and fast path of ReadAccess / WriteAccess.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <type_traits>
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[ScopedAccess]"
+
+// the owner pointer and the debug info (nothing if it is empty), padded to the alignment of the debug info
+constexpr size_t expectedAccessSize()
+{
+    const size_t debug = std::is_empty<ScopedAccessDebugInfo>::value ? 0 : sizeof(ScopedAccessDebugInfo);
+    const size_t align = alignof(ScopedAccessDebugInfo) > alignof(void *) ? alignof(ScopedAccessDebugInfo) : alignof(void *);
+    return (sizeof(void *) + debug + align - 1) / align * align;
+}
+static_assert(sizeof(MyConfigDbManager::ReadAccess) == expectedAccessSize(), "ReadAccess should be just the owner pointer and debug info");
+static_assert(sizeof(MyConfigDbManager::WriteAccess) == expectedAccessSize(), "WriteAccess should be just the owner pointer and debug info");
+
+TEST_CASE("ScopedAccess holds only the owner and debug info", TAG)
+{
+    ESP_LOGI(TAG, "sizeof ReadAccess %u, WriteAccess %u, debug info %u",
+             (unsigned)sizeof(MyConfigDbManager::ReadAccess), (unsigned)sizeof(MyConfigDbManager::WriteAccess),
+             (unsigned)sizeof(ScopedAccessDebugInfo));
+    const size_t limit = sizeof(void *) + sizeof(ScopedAccessDebugInfo) + alignof(ScopedAccessDebugInfo);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(limit, sizeof(MyConfigDbManager::ReadAccess));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(limit, sizeof(MyConfigDbManager::WriteAccess));
+}
+
+TEST_CASE("ScopedAccess uncontended read cost", TAG)
+{
+    const int N = 10000;
+    MyConfigDbManager dbMan{};
+    int acquired = 0;
+
+    const int64_t start = esp_timer_get_time();
+    for (int i = 0; i < N; i++)
+    {
+        if (auto readLock = dbMan.getReadAccess())
+        {
+            acquired++;
+        }
+    }
+    const int64_t elapsed = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "%d uncontended read accesses in %lld us (%lld ns each)", N, (long long)elapsed, (long long)(elapsed * 1000 / N));
+    TEST_ASSERT_EQUAL(N, acquired);
+}
@@ -0,0 +1,168 @@
+/*
+  Unit tests for SeqLockableObject (optimistic reads of small trivially copyable types).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "SeqLockableObject.hpp"
+#include "MyConfigDb.hpp"
+
+#define TAG "[SeqLockableObject]"
+
+// Writers keep check == ~value, so a torn copy is easy to detect.
+struct SensorSnapshot
+{
+    uint32_t value;
+    uint32_t check;
+    uint32_t counter;
+};
+
+using SensorManager = SeqLockableObject<SensorSnapshot>;
+
+static_assert(std::is_same<AutoLockableObject<SensorSnapshot>, SeqLockableObject<SensorSnapshot>>::value, "small POD should pick the seqlock");
+static_assert(std::is_same<AutoLockableObject<MyConfigDb>, LockableObject<MyConfigDb>>::value, "non trivially copyable type should pick LockableObject");
+
+TEST_CASE("SeqLock read and write", TAG)
+{
+    SensorManager sensor{};
+
+    if (auto snap = sensor.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL(0, snap->value);
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to read while no writer.");
+    }
+
+    if (auto access = sensor.getWriteAccess())
+    {
+        access->value = 42;
+        access->check = ~42U;
+        // readers must not see the half-done write
+        SensorSnapshot tmp;
+        TEST_ASSERT_FALSE_MESSAGE(sensor.tryRead(tmp), "Should not read while write.");
+        TEST_ASSERT_FALSE_MESSAGE(bool(sensor.getReadAccess()), "Should not read while write.");
+    }
+
+    auto snap = sensor.getReadAccess();
+    TEST_ASSERT_TRUE_MESSAGE(bool(snap), "Expect to read after write.");
+    TEST_ASSERT_EQUAL(42, snap->value);
+    TEST_ASSERT_EQUAL(~42U, snap->check);
+
+    sensor.reset();
+    TEST_ASSERT_EQUAL(0, sensor.read().value);
+}
+
+TEST_CASE("SeqLock tryReadFromISR never blocks", TAG)
+{
+    SensorManager sensor{};
+    sensor.write(SensorSnapshot{7, ~7U, 1});
+
+    SensorSnapshot tmp{};
+    TEST_ASSERT_TRUE_MESSAGE(sensor.tryReadFromISR(tmp), "Expect to read while no writer.");
+    TEST_ASSERT_EQUAL(7, tmp.value);
+    TEST_ASSERT_EQUAL(~7U, tmp.check);
+
+    if (auto access = sensor.getWriteAccess())
+    {
+        access->value = 8;
+        // same as an ISR that interrupted the writer: fails at once instead of waiting for it
+        const int64_t start = esp_timer_get_time();
+        TEST_ASSERT_FALSE_MESSAGE(sensor.tryReadFromISR(tmp), "Should not read while write.");
+        TEST_ASSERT_LESS_THAN(1000, esp_timer_get_time() - start);
+        access->check = ~8U;
+    }
+    TEST_ASSERT_TRUE(sensor.tryReadFromISR(tmp, 1));
+    TEST_ASSERT_EQUAL(8, tmp.value);
+}
+
+static SensorManager g_sensor{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static volatile int s_torn = 0;
+static volatile int s_reads = 0;
+
+static void seqWriterFunc(void *arg)
+{
+    xSemaphoreGive(s_done_semphr);
+    uint32_t i = 0;
+    while (!s_stop)
+    {
+        if (auto access = g_sensor.getWriteAccess())
+        {
+            access->value = i;
+            access->check = ~i;
+            access->counter++;
+        }
+        i++;
+        if (i % 64 == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+static void seqReaderFunc(void *arg)
+{
+    xSemaphoreGive(s_done_semphr);
+    int i = 0;
+    while (!s_stop)
+    {
+        const SensorSnapshot snap = g_sensor.read();
+        if (snap.check != ~snap.value)
+        {
+            s_torn = s_torn + 1;
+        }
+        s_reads = s_reads + 1;
+        if (++i % 64 == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("SeqLock readers never see a torn copy", TAG)
+{
+    const int NUM_READERS = 4;
+    s_stop = false;
+    s_torn = 0;
+    s_reads = 0;
+    s_done_semphr = xSemaphoreCreateCounting(NUM_READERS + 1, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+
+    xTaskCreatePinnedToCore(seqWriterFunc, "SeqWriter", 2048, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, 0);
+    for (int i = 0; i < NUM_READERS; i++)
+    {
+        xTaskCreatePinnedToCore(seqReaderFunc, "SeqReader", 2048, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, (i + 1) % portNUM_PROCESSORS);
+    }
+    for (int k = 0; k < NUM_READERS + 1; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(3000));
+
+    s_stop = true;
+    for (int k = 0; k < NUM_READERS + 1; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    ESP_LOGI(TAG, "SeqLock test: %d reads, %d torn, %u writes", s_reads, s_torn, (unsigned)g_sensor.read().counter);
+    TEST_ASSERT_EQUAL_MESSAGE(0, s_torn, "Readers must never see a torn copy.");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(1000, s_reads, "Expected many reads.");
+}
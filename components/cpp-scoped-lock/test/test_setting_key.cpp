@@ -0,0 +1,94 @@
+/*
+  Unit tests for hashed setting keys and the MyConfigDb key API.
+*/
+
+#include <string>
+
+#include "esp_heap_caps.h"
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[SettingKey]"
+
+// resolved at compile time
+constexpr SettingKey kBrightness{"brightness"};
+constexpr auto kMode = "mode"_key;
+static_assert(kBrightness.hash == settingHash("brightness"), "hash must be computed at compile time");
+static_assert(kMode.hash != kBrightness.hash, "different names should hash differently");
+
+TEST_CASE("MyConfigDb lookup by hashed key", TAG)
+{
+    MyConfigDbManager dbMan{};
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        dbAccess->set(kBrightness, "80");
+        dbAccess->settings["mode"] = "auto"; // the plain map API still works, and finds the same entry
+        dbAccess->set(kMode, "manual");
+    }
+
+    if (auto dbAccess = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL(2, dbAccess->settings.size());
+        auto brightness = dbAccess->get(kBrightness);
+        TEST_ASSERT_TRUE(brightness.has_value());
+        TEST_ASSERT_TRUE(*brightness == "80");
+        TEST_ASSERT_TRUE(dbAccess->get(kMode) == std::string_view("manual"));
+        TEST_ASSERT_TRUE(dbAccess->contains("mode"_key));
+        TEST_ASSERT_FALSE(dbAccess->get("missing"_key).has_value());
+        // map style access with plain strings goes through the same hashed ordering
+        TEST_ASSERT_EQUAL_STRING("manual", dbAccess->settings.at("mode").c_str());
+        TEST_ASSERT_EQUAL_STRING("80", dbAccess->settings.find(std::string("brightness"))->second.c_str());
+    }
+
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        TEST_ASSERT_TRUE(dbAccess->erase(kMode));
+        TEST_ASSERT_FALSE(dbAccess->erase(kMode));
+        TEST_ASSERT_FALSE(dbAccess->contains(kMode));
+    }
+}
+
+TEST_CASE("MyConfigDb typed getters", TAG)
+{
+    MyConfigDb db;
+    db.set("int", "-42");
+    db.set("hex", "0x1F");
+    db.set("bad_int", "12abc");
+    db.set("bool_on", "ON");
+    db.set("bool_no", "no");
+    db.set("float", "2.5");
+
+    TEST_ASSERT_EQUAL(-42, db.getInt("int").value_or(0));
+    TEST_ASSERT_EQUAL(31, db.getInt("hex").value_or(0));
+    TEST_ASSERT_FALSE(db.getInt("bad_int").has_value());
+    TEST_ASSERT_FALSE(db.getInt("missing").has_value());
+    TEST_ASSERT_TRUE(db.getBool("bool_on").value_or(false));
+    TEST_ASSERT_FALSE(db.getBool("bool_no").value_or(true));
+    TEST_ASSERT_FALSE(db.getBool("float").has_value());
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, db.getFloat("float").value_or(0.0f));
+}
+
+TEST_CASE("MyConfigDb lookups under ReadAccess do not allocate", TAG)
+{
+    MyConfigDbManager dbMan{};
+    // longer than the SSO limit, so building a std::string from it would allocate
+    const char *longKey = "network.wifi.station.reconnect_interval_ms";
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        dbAccess->set(longKey, "1500");
+    }
+
+    if (auto dbAccess = dbMan.getReadAccess())
+    {
+        const size_t freeBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        const std::string_view key{longKey};
+        bool found = dbAccess->settings.find(key) != dbAccess->settings.end();
+        found = found && dbAccess->contains(longKey);
+        const int32_t value = dbAccess->getInt(key).value_or(0);
+        const size_t freeAfter = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+        TEST_ASSERT_TRUE(found);
+        TEST_ASSERT_EQUAL(1500, value);
+        TEST_ASSERT_EQUAL_MESSAGE(freeBefore, freeAfter, "Lookups should not allocate.");
+    }
+}
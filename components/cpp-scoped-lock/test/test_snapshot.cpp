@@ -0,0 +1,61 @@
+/*
+  Unit tests for SnapshotLockableObject (RCU-style snapshot reads).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[SnapshotLockableObject]"
+
+TEST_CASE("Snapshot reads do not block on a writer", TAG)
+{
+    MyConfigDbSnapshotManager dbMan{};
+
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        dbAccess->settings["name"] = "first";
+    }
+
+    auto before = dbMan.getSnapshot();
+    TEST_ASSERT_EQUAL_STRING("first", before->settings.at("name").c_str());
+
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        dbAccess->settings["name"] = "second";
+        // readers still see the published version while the write is in progress
+        auto readAccess = dbMan.getReadAccess();
+        TEST_ASSERT_TRUE_MESSAGE(bool(readAccess), "Expect to read while write.");
+        TEST_ASSERT_EQUAL_STRING("first", readAccess->settings.at("name").c_str());
+    }
+
+    // the new version is visible after the WriteAccess is released; the old snapshot is untouched
+    if (auto readAccess = dbMan.getReadAccess())
+    {
+        TEST_ASSERT_EQUAL_STRING("second", readAccess->settings.at("name").c_str());
+    }
+    TEST_ASSERT_EQUAL_STRING("first", before->settings.at("name").c_str());
+
+    // the old version is reclaimed once the last reader drops it
+    std::weak_ptr<const MyConfigDb> weak = before;
+    before.reset();
+    TEST_ASSERT_TRUE_MESSAGE(weak.expired(), "Expect old version to be freed after last reader.");
+
+    dbMan.reset();
+    TEST_ASSERT_TRUE(dbMan.getSnapshot()->settings.empty());
+}
+
+TEST_CASE("Snapshot write lock is exclusive", TAG)
+{
+    MyConfigDbSnapshotManager dbMan{};
+    if (auto dbAccess = dbMan.getWriteAccess())
+    {
+        auto second = dbMan.getWriteAccess(MyConfigDbSnapshotManager::minBlockTime);
+        TEST_ASSERT_FALSE_MESSAGE(bool(second), "Should not get second write lock.");
+    }
+    auto again = dbMan.getWriteAccess(MyConfigDbSnapshotManager::minBlockTime);
+    TEST_ASSERT_TRUE_MESSAGE(bool(again), "Expect write lock after release.");
+}
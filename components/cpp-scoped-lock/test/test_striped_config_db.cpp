@@ -0,0 +1,189 @@
+/*
+  Unit tests for StripedConfigDb, MyConfigDb split into independently locked stripes.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <string>
+#include <vector>
+
+#include "unity.h"
+#include "StripedConfigDb.hpp"
+
+#define TAG "[StripedConfigDb]"
+
+using TestDb = StripedConfigDb<4>;
+
+// the first key "<prefix><n>" that is in `stripe`
+static std::string keyInStripe(std::size_t stripe, const char *prefix = "key")
+{
+    for (int n = 0;; n++)
+    {
+        std::string name = prefix + std::to_string(n);
+        if (TestDb::stripeOf(name) == stripe)
+        {
+            return name;
+        }
+    }
+}
+
+TEST_CASE("StripedConfigDb keys spread over the stripes", TAG)
+{
+    MyConfigDb factory{};
+    factory.set("wifi.mode", "station");
+    std::vector<uint8_t> defaults;
+    factory.serialize(defaults, true, true);
+
+    TestDb dbMan{};
+    dbMan.setDefaults(ConfigBlobView(defaults.data(), defaults.size()));
+    for (int i = 0; i < 40; i++)
+    {
+        dbMan.set("key" + std::to_string(i), std::to_string(i));
+    }
+    TEST_ASSERT_TRUE(dbMan.get("key7") == std::string("7"));
+    TEST_ASSERT_TRUE(dbMan.get("wifi.mode") == std::string("station"));
+    TEST_ASSERT_FALSE(dbMan.get("missing").has_value());
+    for (std::size_t i = 0; i < TestDb::stripes; i++)
+    {
+        TEST_ASSERT_GREATER_THAN_MESSAGE(0, dbMan.stripe(i).getReadAccess()->settings.size(), "Expected keys in every stripe.");
+    }
+    TEST_ASSERT_EQUAL(7, dbMan.getReadAccess("key7")->getInt("key7").value_or(-1));
+
+    if (auto all = dbMan.getAllReadAccess())
+    {
+        TEST_ASSERT_EQUAL(40, all.size());
+        int count = 0;
+        all.forEachSetting([&count](SettingKey key, std::string_view value) { count++; });
+        TEST_ASSERT_EQUAL_MESSAGE(41, count, "Expected the defaults once, not once per stripe.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get all stripes.");
+    }
+
+    TEST_ASSERT_TRUE(dbMan.erase("key7"));
+    TEST_ASSERT_FALSE(dbMan.erase("key7"));
+    dbMan.reset();
+    TEST_ASSERT_EQUAL(0, dbMan.getAllReadAccess().size());
+    TEST_ASSERT_TRUE_MESSAGE(dbMan.get("wifi.mode") == std::string("station"), "Expected the defaults kept by reset().");
+}
+
+TEST_CASE("StripedConfigDb writer blocks only its stripe", TAG)
+{
+    TestDb dbMan{};
+    const std::string a = keyInStripe(0);
+    const std::string sameStripe = keyInStripe(0, "other");
+    const std::string b = keyInStripe(1);
+    dbMan.set(b, "1");
+
+    if (auto db = dbMan.getWriteAccess(a))
+    {
+        db->set(a, "0");
+        TEST_ASSERT_TRUE_MESSAGE(dbMan.get(b) == std::string("1"), "Expected a reader of another stripe not to wait.");
+        TEST_ASSERT_TRUE(bool(dbMan.getWriteAccess(b, TestDb::minBlockTime)));
+        TEST_ASSERT_FALSE(bool(dbMan.getReadAccess(sameStripe)));
+        TEST_ASSERT_FALSE_MESSAGE(bool(dbMan.getAllReadAccess()), "Should not get all stripes while one is locked.");
+    }
+    // a failed getAllWriteAccess() must not keep stripes locked
+    if (auto db = dbMan.getReadAccess(keyInStripe(2)))
+    {
+        TEST_ASSERT_FALSE(bool(dbMan.getAllWriteAccess(std::chrono::milliseconds(20))));
+        TEST_ASSERT_TRUE(bool(dbMan.getWriteAccess(a, TestDb::minBlockTime)));
+    }
+    TEST_ASSERT_TRUE(bool(dbMan.getAllWriteAccess(TestDb::minBlockTime)));
+}
+
+static TestDb g_dbMan{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile int s_writes[TestDb::stripes] = {};
+
+static void stripeWriterFunc(void *arg)
+{
+    const int stripe = (int)(intptr_t)arg;
+    const std::string name = keyInStripe(stripe);
+    for (int i = 0; i < 300; i++)
+    {
+        if (auto db = g_dbMan.getWriteAccess(name))
+        {
+            db->set(name, std::to_string(i));
+            s_writes[stripe] = s_writes[stripe] + 1;
+        }
+        if ((i % 16) == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+static void iterateFunc(void *arg)
+{
+    for (int i = 0; i < 50; i++)
+    {
+        if (auto all = g_dbMan.getAllReadAccess(std::chrono::milliseconds(1000)))
+        {
+            all.forEachSetting([](SettingKey, std::string_view) {});
+        }
+        vTaskDelay(1);
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("StripedConfigDb writers in parallel with a whole-database reader", TAG)
+{
+    g_dbMan.reset();
+    s_done_semphr = xSemaphoreCreateCounting(TestDb::stripes + 1, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    for (std::size_t i = 0; i < TestDb::stripes; i++)
+    {
+        s_writes[i] = 0;
+        xTaskCreatePinnedToCore(stripeWriterFunc, "StripeWriter", 4096, (void *)(intptr_t)i, ESP_TASK_MAIN_PRIO + 1, nullptr, i % portNUM_PROCESSORS);
+    }
+    xTaskCreatePinnedToCore(iterateFunc, "Iterate", 4096, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, 0);
+    for (std::size_t k = 0; k < TestDb::stripes + 1; k++)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(pdTRUE == xSemaphoreTake(s_done_semphr, pdMS_TO_TICKS(20000)), "Tasks did not finish.");
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    for (std::size_t i = 0; i < TestDb::stripes; i++)
+    {
+        TEST_ASSERT_EQUAL(300, s_writes[i]);
+        TEST_ASSERT_TRUE(g_dbMan.get(keyInStripe(i)) == std::string("299"));
+    }
+}
+
+static void holdStripeFunc(void *arg)
+{
+    if (auto db = g_dbMan.getWriteAccess(keyInStripe(0)))
+    {
+        xSemaphoreGive(s_done_semphr);
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("StripedConfigDb set waits for a busy stripe", TAG)
+{
+    g_dbMan.reset();
+    s_done_semphr = xSemaphoreCreateCounting(2, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    xTaskCreatePinnedToCore(holdStripeFunc, "HoldStripe", 4096, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, 0);
+    TEST_ASSERT_TRUE(pdTRUE == xSemaphoreTake(s_done_semphr, pdMS_TO_TICKS(1000)));
+
+    // the default timeout is "forever", also for std::shared_timed_mutex
+    TEST_ASSERT_TRUE_MESSAGE(g_dbMan.set(keyInStripe(0), "1"), "Expected set() to wait for the stripe.");
+    TEST_ASSERT_TRUE(g_dbMan.get(keyInStripe(0)) == std::string("1"));
+    TEST_ASSERT_TRUE(g_dbMan.erase(keyInStripe(0)));
+    TEST_ASSERT_TRUE(pdTRUE == xSemaphoreTake(s_done_semphr, pdMS_TO_TICKS(1000)));
+    vSemaphoreDelete(s_done_semphr);
+}
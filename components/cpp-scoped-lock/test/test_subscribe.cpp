@@ -0,0 +1,146 @@
+/*
+  Unit tests for LockableObject change subscriptions and MyConfigDb change tracking.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <string>
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+
+#define TAG "[subscribe]"
+
+static const uint32_t CONFIG_CHANGED_BIT = 1U << 3;
+
+// returns the notification bits received (and clears them)
+static uint32_t takeNotification(TickType_t ticks)
+{
+    uint32_t bits = 0;
+    if (pdTRUE != xTaskNotifyWait(0, UINT32_MAX, &bits, ticks))
+    {
+        return 0;
+    }
+    return bits;
+}
+
+TEST_CASE("Subscribers are notified after writes", TAG)
+{
+    MyConfigDbManager dbMan{};
+    takeNotification(0); // drop anything left over from other tests
+
+    TEST_ASSERT_TRUE(dbMan.subscribe(CONFIG_CHANGED_BIT));
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        writeLock->set("a", "1");
+        TEST_ASSERT_EQUAL_UINT32(0, takeNotification(0)); // not before the lock is released
+    }
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_CHANGED_BIT, takeNotification(0));
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        (void)readLock->get("a");
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, takeNotification(0), "Reads should not notify.");
+
+    dbMan.postWrite([](MyConfigDb &db) { db.set("b", "2"); });
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_CHANGED_BIT, takeNotification(0));
+
+    dbMan.unsubscribe();
+    dbMan.getWriteAccess()->set("c", "3");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, takeNotification(0), "Should not notify after unsubscribe.");
+}
+
+TEST_CASE("MyConfigDb reports what changed since a revision", TAG)
+{
+    MyConfigDb db{};
+    db.set("a", "1");
+    db.set("b", "2");
+    const uint32_t seen = db.revision();
+
+    db.set("b", "3");
+    db.set("c", "4");
+    db.erase("a");
+    db.erase("missing"); // no change
+
+    std::string changed;
+    db.forEachChangedSince(seen, [&changed](SettingKey key, std::optional<std::string_view> value) {
+        changed += std::string(key.name) + "=" + (value ? std::string(*value) : std::string("-")) + ";";
+    });
+    // iteration is in (hash, name) order, so check each entry separately
+    TEST_ASSERT_TRUE(changed.find("a=-;") != std::string::npos);
+    TEST_ASSERT_TRUE(changed.find("b=3;") != std::string::npos);
+    TEST_ASSERT_TRUE(changed.find("c=4;") != std::string::npos);
+    TEST_ASSERT_EQUAL(12, changed.size());
+
+    int count = 0;
+    db.forEachChangedSince(db.revision(), [&count](SettingKey, std::optional<std::string_view>) { count++; });
+    TEST_ASSERT_EQUAL(0, count);
+}
+
+TEST_CASE("MyConfigDb forgets the changes up to a revision", TAG)
+{
+    MyConfigDb db{};
+    db.set("a", "1");
+    db.set("b", "2");
+    const uint32_t seen = db.revision();
+    db.set("c", "3");
+
+    db.forgetChangesUpTo(seen);
+    TEST_ASSERT_EQUAL_UINT32(seen, db.forgottenUpTo());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, db.changedAt("a"), "Expected the record of a dropped.");
+    TEST_ASSERT_EQUAL_UINT32(db.revision(), db.changedAt("c"));
+    TEST_ASSERT_TRUE_MESSAGE(db.get("a") == "1", "Only the record is dropped, not the setting.");
+
+    int count = 0;
+    TEST_ASSERT_FALSE_MESSAGE(db.forEachChangedSince(seen - 1, [&count](SettingKey, std::optional<std::string_view>) { count++; }),
+                              "Expected false for a revision older than the records.");
+    TEST_ASSERT_EQUAL(0, count);
+    TEST_ASSERT_TRUE(db.forEachChangedSince(seen, [&count](SettingKey, std::optional<std::string_view>) { count++; }));
+    TEST_ASSERT_EQUAL(1, count);
+
+    db.forgetChangesUpTo(db.revision() + 10); // not beyond what happened
+    TEST_ASSERT_EQUAL_UINT32(db.revision(), db.forgottenUpTo());
+    TEST_ASSERT_EQUAL_UINT32(0, db.changedAt("c"));
+}
+
+static MyConfigDbManager g_NotifyDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+
+static void notifyingWriterFunc(void *arg)
+{
+    while (!s_stop)
+    {
+        g_NotifyDbManager.getWriteAccess()->set("busy", "1");
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("No notification arrives after unsubscribe returns", TAG)
+{
+    s_stop = false;
+    s_done_semphr = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(notifyingWriterFunc, "NotifyWriter", 3072, nullptr, uxTaskPriorityGet(nullptr), nullptr,
+                            portNUM_PROCESSORS - 1);
+    int late = 0;
+    for (int i = 0; i < 200; i++)
+    {
+        TEST_ASSERT_TRUE(g_NotifyDbManager.subscribe(CONFIG_CHANGED_BIT));
+        vTaskDelay(1);
+        g_NotifyDbManager.unsubscribe();
+        takeNotification(0);
+        late += takeNotification(1) ? 1 : 0;
+    }
+    s_stop = true;
+    xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    vSemaphoreDelete(s_done_semphr);
+    TEST_ASSERT_EQUAL_MESSAGE(0, late, "Expected unsubscribe() to wait for the notifications on their way.");
+}
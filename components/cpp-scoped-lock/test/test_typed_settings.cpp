@@ -0,0 +1,125 @@
+/*
+  Unit tests for TypedSettings, the schema-driven settings with binary values.
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+
+#include <string>
+
+#include "unity.h"
+#include "LockableObject.hpp"
+#include "SeqLockableObject.hpp"
+#include "TypedSettings.hpp"
+
+#define TAG "[TypedSettings]"
+
+namespace
+{
+    enum class WifiMode
+    {
+        Off,
+        Station,
+        Ap,
+    };
+    inline constexpr const char *wifiModeNames[] = {"off", "station", "ap"};
+    inline constexpr SettingDef testSchema[] = {
+        intSetting("wifi.retries", 5, 0, 100),
+        floatSetting("sensor.gain", 1.5f),
+        boolSetting("led.enabled", true),
+        enumSetting("wifi.mode", WifiMode::Station, wifiModeNames),
+    };
+    using TestSettings = TypedSettings<testSchema>;
+    constexpr auto wifiRetries = TestSettings::key<int32_t>("wifi.retries");
+    constexpr auto sensorGain = TestSettings::key<float>("sensor.gain");
+    constexpr auto ledEnabled = TestSettings::key<bool>("led.enabled");
+    constexpr auto wifiMode = TestSettings::key<WifiMode>("wifi.mode");
+} // namespace
+
+static_assert(sizeof(TestSettings) == 4 * TestSettings::count, "Expected 4 bytes per setting.");
+static_assert(wifiMode.index == 3, "Expected the keys resolved at compile time.");
+
+TEST_CASE("TypedSettings defaults and range checked set", TAG)
+{
+    TestSettings settings{};
+    TEST_ASSERT_EQUAL(5, settings.get(wifiRetries));
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, settings.get(sensorGain));
+    TEST_ASSERT_TRUE(settings.get(ledEnabled));
+    TEST_ASSERT_TRUE(settings.get(wifiMode) == WifiMode::Station);
+    TEST_ASSERT_TRUE(settings.isDefault(wifiRetries));
+
+    TEST_ASSERT_TRUE(settings.set(wifiRetries, 7));
+    TEST_ASSERT_FALSE_MESSAGE(settings.set(wifiRetries, 101), "Expected the range of the schema enforced.");
+    TEST_ASSERT_EQUAL(7, settings.get(wifiRetries));
+    TEST_ASSERT_FALSE(settings.isDefault(wifiRetries));
+    TEST_ASSERT_TRUE(settings.set(wifiMode, WifiMode::Ap));
+    TEST_ASSERT_FALSE(settings.set(wifiMode, static_cast<WifiMode>(3)));
+    TEST_ASSERT_TRUE(settings.get(wifiMode) == WifiMode::Ap);
+
+    settings.reset();
+    TEST_ASSERT_EQUAL(5, settings.get(wifiRetries));
+    TEST_ASSERT_TRUE(settings.get(wifiMode) == WifiMode::Station);
+}
+
+TEST_CASE("TypedSettings strings only at import and export", TAG)
+{
+    MyConfigDb db{};
+    db.set("wifi.retries", "0x10");
+    db.set("sensor.gain", "not a number");
+    db.set("led.enabled", "off");
+    db.set("wifi.mode", "ap");
+    db.set("unrelated", "kept");
+
+    TestSettings settings{};
+    TEST_ASSERT_EQUAL_MESSAGE(3, settings.importFrom(db), "Expected the invalid value skipped.");
+    TEST_ASSERT_EQUAL(16, settings.get(wifiRetries));
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, settings.get(sensorGain));
+    TEST_ASSERT_FALSE(settings.get(ledEnabled));
+    TEST_ASSERT_TRUE(settings.get(wifiMode) == WifiMode::Ap);
+
+    TEST_ASSERT_TRUE(settings.setFromString("sensor.gain", "0.25"));
+    TEST_ASSERT_TRUE(settings.setFromString("wifi.mode", "0"));
+    TEST_ASSERT_FALSE(settings.setFromString("wifi.mode", "mesh"));
+    TEST_ASSERT_FALSE(settings.setFromString("wifi.retries", "-1"));
+    TEST_ASSERT_FALSE(settings.setFromString("unknown", "1"));
+    TEST_ASSERT_TRUE(settings.toString("wifi.mode") == std::string("off"));
+    TEST_ASSERT_TRUE(settings.toString("sensor.gain") == std::string("0.25"));
+    TEST_ASSERT_FALSE(settings.toString("unknown").has_value());
+
+    TEST_ASSERT_TRUE(settings.set(ledEnabled, true)); // back to the default
+    settings.exportTo(db);
+    TEST_ASSERT_TRUE(db.get("wifi.retries") == "16");
+    TEST_ASSERT_TRUE(db.get("wifi.mode") == "off");
+    TEST_ASSERT_FALSE_MESSAGE(db.contains("led.enabled"), "Expected defaults erased.");
+    TEST_ASSERT_TRUE(db.get("unrelated") == "kept");
+
+    const uint32_t revision = db.revision();
+    settings.exportTo(db);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(revision, db.revision(), "Expected no changes from exporting the same values.");
+
+    TestSettings reimported{};
+    reimported.importFrom(db);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, reimported.get(sensorGain));
+    TEST_ASSERT_TRUE(reimported.get(wifiMode) == WifiMode::Off);
+}
+
+TEST_CASE("TypedSettings under LockableObject and SeqLockableObject", TAG)
+{
+    LockableObject<TestSettings> locked{};
+    if (auto settings = locked.getWriteAccess())
+    {
+        TEST_ASSERT_TRUE(settings->set(wifiRetries, 9));
+    }
+    TEST_ASSERT_EQUAL(9, locked.getReadAccess()->get(wifiRetries));
+
+    SeqLockableObject<TestSettings> seq{};
+    if (auto settings = seq.getWriteAccess())
+    {
+        settings->set(wifiMode, WifiMode::Off);
+    }
+    auto copy = seq.getReadAccess();
+    TEST_ASSERT_TRUE(copy);
+    TEST_ASSERT_TRUE(copy->get(wifiMode) == WifiMode::Off);
+    TEST_ASSERT_EQUAL(5, copy->get(wifiRetries));
+}
@@ -0,0 +1,110 @@
+/*
+  Unit tests for UpgradableMutex / LockableObject::getUpgradableAccess().
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "unity.h"
+#include "MyConfigDb.hpp"
+#include "AdaptiveSpinMutex.hpp"
+#include "FreeRtosSharedMutex.hpp"
+#include "PerCoreSharedMutex.hpp"
+
+#define TAG "[UpgradableMutex]"
+
+template <class Manager>
+static void checkUpgradableLocking()
+{
+    Manager dbMan{};
+
+    if (auto access = dbMan.getUpgradableAccess())
+    {
+        TEST_ASSERT_FALSE(access.isUpgraded());
+        {
+            auto readLock = dbMan.getReadAccess();
+            TEST_ASSERT_TRUE_MESSAGE(bool(readLock), "Expect readers to share with the upgradable access.");
+            auto second = dbMan.getUpgradableAccess(Manager::minBlockTime);
+            TEST_ASSERT_FALSE_MESSAGE(bool(second), "Should not get a second upgradable access.");
+            auto writeLock = dbMan.getWriteAccess(Manager::minBlockTime);
+            TEST_ASSERT_FALSE_MESSAGE(bool(writeLock), "Should not get write lock while upgradable.");
+            TEST_ASSERT_FALSE_MESSAGE(access.upgrade(Manager::minBlockTime), "Should not upgrade while another reader is active.");
+            TEST_ASSERT_TRUE_MESSAGE(bool(access), "Expect to keep the shared access after a failed upgrade.");
+        }
+        TEST_ASSERT_TRUE_MESSAGE(access.upgrade(), "Expect to upgrade once the reader left.");
+        TEST_ASSERT_TRUE(access.isUpgraded());
+        access->set("key", "value");
+        TEST_ASSERT_FALSE_MESSAGE(bool(dbMan.getReadAccess()), "Should not get read lock while upgraded.");
+    }
+    else
+    {
+        TEST_FAIL_MESSAGE("Expect to get upgradable access.");
+    }
+
+    auto readLock = dbMan.getReadAccess();
+    TEST_ASSERT_TRUE_MESSAGE(bool(readLock), "Expect to get read lock after release.");
+    TEST_ASSERT_EQUAL_STRING("value", readLock->settings.at("key").c_str());
+    TEST_ASSERT_TRUE_MESSAGE(bool(dbMan.getUpgradableAccess(Manager::minBlockTime)), "Expect to get upgradable access while read.");
+}
+
+TEST_CASE("Upgradable access locking", TAG)
+{
+    checkUpgradableLocking<MyConfigDbUpgradableManager>();
+    checkUpgradableLocking<LockableObject<MyConfigDb, UpgradableMutex<FreeRtosSharedMutex>>>();
+    checkUpgradableLocking<LockableObject<MyConfigDb, UpgradableMutex<PerCoreSharedMutex>>>();
+    checkUpgradableLocking<LockableObject<MyConfigDb, UpgradableMutex<AdaptiveSpinMutex<PerCoreSharedMutex>>>>();
+}
+
+static MyConfigDbUpgradableManager g_UpgradableDbManager{};
+static SemaphoreHandle_t s_done_semphr;
+static volatile int s_lost_updates = 0;
+
+// Increment a counter with check-then-write. Without the upgrade, concurrent tasks would lose updates.
+static void incrementerFunc(void *arg)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        if (auto access = g_UpgradableDbManager.getUpgradableAccess())
+        {
+            const int value = access->getInt("count").value_or(0);
+            if (access.upgrade())
+            {
+                access->set("count", std::to_string(value + 1));
+            }
+            else
+            {
+                s_lost_updates = s_lost_updates + 1;
+            }
+        }
+        vTaskDelay(1);
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("Upgradable access check-then-write from several tasks", TAG)
+{
+    const int NUM_TASKS = 3;
+    g_UpgradableDbManager.reset();
+    s_lost_updates = 0;
+    s_done_semphr = xSemaphoreCreateCounting(NUM_TASKS, 0);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    for (int i = 0; i < NUM_TASKS; i++)
+    {
+        xTaskCreatePinnedToCore(incrementerFunc, "Upgrader", 4096, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, i % portNUM_PROCESSORS);
+    }
+    for (int k = 0; k < NUM_TASKS; k++)
+    {
+        xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    }
+    vSemaphoreDelete(s_done_semphr);
+
+    TEST_ASSERT_EQUAL(0, s_lost_updates);
+    auto readLock = g_UpgradableDbManager.getReadAccess();
+    TEST_ASSERT_EQUAL(NUM_TASKS * 100, readLock->getInt("count").value_or(0));
+}
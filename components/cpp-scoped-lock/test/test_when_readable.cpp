@@ -0,0 +1,112 @@
+/*
+  Unit tests for LockableObject::whenReadable() (queued reads, for event loops that must not block).
+*/
+
+/* Enable this to show verbose logging for this file only. */
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#include "esp_log.h"
+#include "esp_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <string>
+#include <vector>
+
+#include "unity.h"
+#include "FreeRtosSharedMutex.hpp"
+#include "MyConfigDb.hpp"
+
+#define TAG "[whenReadable]"
+
+TEST_CASE("whenReadable runs now or when the writer releases", TAG)
+{
+    MyConfigDbManager dbMan{};
+    std::vector<std::string> seen;
+
+    dbMan.whenReadable([&seen](const MyConfigDb &db) { seen.emplace_back("free"); });
+    TEST_ASSERT_EQUAL_MESSAGE(1, seen.size(), "Expect to run at once when the lock is free.");
+
+    if (auto readLock = dbMan.getReadAccess())
+    {
+        dbMan.whenReadable([&seen](const MyConfigDb &db) { seen.emplace_back("shared"); });
+        TEST_ASSERT_EQUAL_MESSAGE(2, seen.size(), "Expect to share the lock with a reader.");
+    }
+
+    if (auto writeLock = dbMan.getWriteAccess())
+    {
+        dbMan.whenReadable([&seen](const MyConfigDb &db) { seen.emplace_back(db.get("mode").value_or("none")); });
+        dbMan.whenReadable([&seen](const MyConfigDb &db) { seen.emplace_back("second"); });
+        writeLock->set("mode", "ap");
+        TEST_ASSERT_TRUE(dbMan.hasPendingReads());
+        TEST_ASSERT_EQUAL(2, seen.size());
+    }
+    TEST_ASSERT_FALSE_MESSAGE(dbMan.hasPendingReads(), "Expect the writer to run the queue on release.");
+    TEST_ASSERT_EQUAL(4, seen.size());
+    TEST_ASSERT_TRUE_MESSAGE(seen[2] == "ap", "Expect the queued read to see the write.");
+    TEST_ASSERT_TRUE(seen[3] == "second");
+
+    // a policy with its own traits
+    LockableObject<MyConfigDb, FreeRtosSharedMutex> otherMan{};
+    bool ran = false;
+    if (auto writeLock = otherMan.getWriteAccess())
+    {
+        otherMan.whenReadable([&ran](const MyConfigDb &) { ran = true; });
+        TEST_ASSERT_FALSE(ran);
+    }
+    TEST_ASSERT_TRUE(ran);
+}
+
+static MyConfigDbManager g_dbMan{};
+static SemaphoreHandle_t s_result_semphr;
+static SemaphoreHandle_t s_done_semphr;
+static volatile bool s_stop = false;
+static const int REQUESTS = 200;
+
+// holds the write lock for a tick at a time
+static void busyWriterFunc(void *arg)
+{
+    for (int i = 0; !s_stop; i++)
+    {
+        if (auto db = g_dbMan.getWriteAccess())
+        {
+            db->set("count", std::to_string(i));
+            vTaskDelay(1);
+        }
+        vTaskDelay(1);
+    }
+    xSemaphoreGive(s_done_semphr);
+    vTaskDelete(nullptr);
+}
+
+TEST_CASE("whenReadable serves an event loop without blocking it", TAG)
+{
+    s_stop = false;
+    s_result_semphr = xSemaphoreCreateCounting(REQUESTS, 0);
+    s_done_semphr = xSemaphoreCreateCounting(1, 0);
+    TEST_ASSERT_NOT_NULL(s_result_semphr);
+    TEST_ASSERT_NOT_NULL(s_done_semphr);
+    xTaskCreatePinnedToCore(busyWriterFunc, "BusyWriter", 4096, nullptr, ESP_TASK_MAIN_PRIO + 1, nullptr, 1 % portNUM_PROCESSORS);
+
+    // this task is the event loop: it posts requests and never waits for the lock
+    const TickType_t start = xTaskGetTickCount();
+    for (int i = 0; i < REQUESTS; i++)
+    {
+        g_dbMan.whenReadable([](const MyConfigDb &db) { xSemaphoreGive(s_result_semphr); });
+    }
+    const TickType_t posting = xTaskGetTickCount() - start;
+    int answered = 0;
+    while (answered < REQUESTS && pdTRUE == xSemaphoreTake(s_result_semphr, pdMS_TO_TICKS(2000)))
+    {
+        answered++;
+    }
+    s_stop = true;
+    xSemaphoreTake(s_done_semphr, portMAX_DELAY);
+    vSemaphoreDelete(s_done_semphr);
+    vSemaphoreDelete(s_result_semphr);
+
+    ESP_LOGI(TAG, "posting %d reads took %u ticks", REQUESTS, (unsigned)posting);
+    TEST_ASSERT_EQUAL(REQUESTS, answered);
+    TEST_ASSERT_FALSE(g_dbMan.hasPendingReads());
+    TEST_ASSERT_LESS_THAN_MESSAGE(REQUESTS / 2, posting, "Expected posting not to wait for the writer.");
+}
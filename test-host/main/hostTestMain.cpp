@@ -0,0 +1,36 @@
+/*
+ * Runs the component tests on the host.
+ *
+ *   host_tests                  all tests
+ *   host_tests "[seqlock]"      tests with this tag, or the test with this name
+ *   host_tests -x "[bench]"     all tests except those with this tag
+ *   host_tests -l               list the tests
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "unity.h"
+
+int main(int argc, char **argv)
+{
+    const char *include = nullptr;
+    const char *exclude = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "-l") == 0)
+        {
+            unityHostList();
+            return 0;
+        }
+        if (std::strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+        {
+            exclude = argv[++i];
+        }
+        else
+        {
+            include = argv[i];
+        }
+    }
+    return unityHostRun(include, exclude) ? 1 : 0;
+}
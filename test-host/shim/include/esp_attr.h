@@ -0,0 +1,8 @@
+/*
+ * esp_attr.h (host)
+ */
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
@@ -0,0 +1,9 @@
+/*
+ * esp_cpu.h (host)
+ */
+#pragma once
+
+#include <cstdint>
+
+// The time stamp counter on x86, otherwise steady_clock nanoseconds. Only differences on one thread are meaningful.
+uint32_t esp_cpu_get_cycle_count(void);
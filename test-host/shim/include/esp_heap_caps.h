@@ -0,0 +1,21 @@
+/*
+ * esp_heap_caps.h (host)
+ *  heap_caps_* allocate from the process heap; the capabilities are ignored.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+// Decreases by what the process has allocated (glibc mallinfo2), so allocation checks work like on the target
+size_t heap_caps_get_free_size(uint32_t caps);
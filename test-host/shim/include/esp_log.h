@@ -0,0 +1,41 @@
+/*
+ * esp_log.h (host)
+ *  ESP_LOGx print to stdout, filtered by LOG_LOCAL_LEVEL (default ESP_LOG_INFO) like on the target.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_INFO
+#endif
+
+uint32_t esp_log_timestamp(void);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+
+#define ESP_HOST_LOG(level, letter, tag, format, ...)                                                          \
+    do                                                                                                         \
+    {                                                                                                          \
+        if (LOG_LOCAL_LEVEL >= level)                                                                          \
+        {                                                                                                      \
+            esp_log_write(level, tag, letter " (%u) %s: " format "\n", (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__); \
+        }                                                                                                      \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_HOST_LOG(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_HOST_LOG(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_HOST_LOG(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_HOST_LOG(ESP_LOG_DEBUG, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_HOST_LOG(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
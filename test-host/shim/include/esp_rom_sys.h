@@ -0,0 +1,9 @@
+/*
+ * esp_rom_sys.h (host)
+ */
+#pragma once
+
+#include <cstdint>
+
+// Rate of esp_cpu_get_cycle_count(), calibrated once against steady_clock
+uint32_t esp_rom_get_cpu_ticks_per_us(void);
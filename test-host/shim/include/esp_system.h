@@ -0,0 +1,6 @@
+/*
+ * esp_system.h (host)
+ */
+#pragma once
+
+const char *esp_get_idf_version(void); // "host"
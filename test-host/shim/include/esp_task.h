@@ -0,0 +1,9 @@
+/*
+ * esp_task.h (host)
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#define ESP_TASK_PRIO_MIN (1)
+#define ESP_TASK_MAIN_PRIO (ESP_TASK_PRIO_MIN)
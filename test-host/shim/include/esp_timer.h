@@ -0,0 +1,9 @@
+/*
+ * esp_timer.h (host)
+ */
+#pragma once
+
+#include <cstdint>
+
+// Microseconds since the start of the program (std::chrono::steady_clock)
+int64_t esp_timer_get_time(void);
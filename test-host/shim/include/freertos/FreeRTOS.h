@@ -0,0 +1,64 @@
+/*
+ * FreeRTOS.h (host)
+ *  The subset of the ESP-IDF FreeRTOS API used by the components, on top of std::thread (see freertosHost.cpp).
+ *  Tasks are threads, a tick is 1000 / configTICK_RATE_HZ ms of std::chrono::steady_clock.
+ *  Priorities are recorded but not enforced, and critical sections don't stop the other "core".
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((uint64_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000U))
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+// Number of simulated cores (xPortGetCoreID() range, core argument of xTaskCreatePinnedToCore())
+#ifndef portNUM_PROCESSORS
+#define portNUM_PROCESSORS 2
+#endif
+#define tskNO_AFFINITY ((BaseType_t)0x7fffffff)
+
+// A recursive spinlock, like the ESP-IDF portMUX
+struct portMUX_TYPE
+{
+    std::atomic<uint32_t> owner;
+    uint32_t count;
+};
+#define portMUX_INITIALIZER_UNLOCKED {{0}, 0}
+#define portMUX_INITIALIZE(mux) vPortMuxInitialize(mux)
+
+void vPortMuxInitialize(portMUX_TYPE *mux);
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(x) (void)(x)
+
+BaseType_t xPortGetCoreID(void);
+BaseType_t xPortInIsrContext(void); // always false, there are no interrupts on the host
+
+// Storage for the *Static() creation functions. The host objects are allocated on the heap anyway.
+typedef struct
+{
+    void *dummy[4];
+} StaticSemaphore_t;
+typedef StaticSemaphore_t StaticQueue_t;
+typedef StaticSemaphore_t StaticEventGroup_t;
@@ -0,0 +1,10 @@
+/*
+ * nvs_flash.h (host)
+ *  The in-memory NVS lives as long as the process; nvs_flash_erase() empties it.
+ */
+#pragma once
+
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
@@ -0,0 +1,47 @@
+/*
+ * sdkconfig.h (host)
+ *  The configuration of the test apps (test-idf4/test-idf5 sdkconfig.defaults). Each option can be overridden
+ *  from CMake, i.e. -DCONFIG_SCOPED_LOCK_STATS=0 (see test-host/CMakeLists.txt).
+ */
+#pragma once
+
+#ifndef CONFIG_IDF_TARGET
+#define CONFIG_IDF_TARGET "linux"
+#define CONFIG_IDF_TARGET_LINUX 1
+#endif
+#ifndef CONFIG_FREERTOS_HZ
+#define CONFIG_FREERTOS_HZ 100
+#endif
+#ifndef CONFIG_SCOPED_LOCK_STATS
+#define CONFIG_SCOPED_LOCK_STATS 1
+#endif
+#ifndef CONFIG_SCOPED_LOCK_WATCHDOG
+#define CONFIG_SCOPED_LOCK_WATCHDOG 1
+#endif
+#ifndef CONFIG_SCOPED_LOCK_WATCHDOG_SLOTS
+#define CONFIG_SCOPED_LOCK_WATCHDOG_SLOTS 16
+#endif
+#ifndef CONFIG_SCOPED_LOCK_WATCHDOG_THRESHOLD_MS
+#define CONFIG_SCOPED_LOCK_WATCHDOG_THRESHOLD_MS 500
+#endif
+#ifndef CONFIG_SCOPED_LOCK_MAX_SUBSCRIBERS
+#define CONFIG_SCOPED_LOCK_MAX_SUBSCRIBERS 4
+#endif
+#ifndef CONFIG_SCOPED_LOCK_NVS_COALESCE_MS
+#define CONFIG_SCOPED_LOCK_NVS_COALESCE_MS 200
+#endif
+#ifndef CONFIG_SCOPED_LOCK_CONFIG_DB_STRIPES
+#define CONFIG_SCOPED_LOCK_CONFIG_DB_STRIPES 8
+#endif
+#ifndef CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS
+#define CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS 2
+#endif
+#ifndef CONFIG_SCOPED_LOCK_TASK_CACHE
+#define CONFIG_SCOPED_LOCK_TASK_CACHE 1
+#endif
+#ifndef CONFIG_SCOPED_LOCK_TASK_CACHE_TLS_INDEX
+#define CONFIG_SCOPED_LOCK_TASK_CACHE_TLS_INDEX 1
+#endif
+#ifndef CONFIG_SCOPED_LOCK_SPIN_MAX
+#define CONFIG_SCOPED_LOCK_SPIN_MAX 400
+#endif
@@ -0,0 +1,133 @@
+/*
+ * unity.h (host)
+ *  The part of the ESP-IDF Unity API used by the component tests: TEST_CASE registration and the TEST_ASSERT_* macros.
+ *  A failed assertion throws (instead of Unity's longjmp), so the scoped locks of the test are released on the way out.
+ *  Run the tests with unityHostRun() (unityHost.cpp).
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+typedef void (*UnityHostTestFunction)(void);
+
+struct UnityHostRegistration
+{
+    UnityHostRegistration(const char *name, const char *tags, const char *file, int line, UnityHostTestFunction fn);
+};
+
+// Run the registered tests whose tags contain `include` (all if nullptr), except those with `exclude` (none if nullptr).
+// Returns the number of failures.
+int unityHostRun(const char *include, const char *exclude);
+void unityHostList();
+
+[[noreturn]] void unityHostFail(const char *file, int line, const char *message, const char *detail);
+[[noreturn]] void unityHostIgnore(const char *file, int line, const char *message);
+[[noreturn]] void unityHostFailInt(const char *file, int line, const char *message, const char *relation, intmax_t expected,
+                                   intmax_t actual);
+
+#define UNITY_HOST_CAT2(a, b) a##b
+#define UNITY_HOST_CAT(a, b) UNITY_HOST_CAT2(a, b)
+
+#define TEST_CASE(name_, tags_)                                                                                          \
+    static void UNITY_HOST_CAT(unityHostTest_, __LINE__)(void);                                                          \
+    static UnityHostRegistration UNITY_HOST_CAT(unityHostRegistration_, __LINE__)(name_, tags_, __FILE__, __LINE__,     \
+                                                                                  UNITY_HOST_CAT(unityHostTest_, __LINE__)); \
+    static void UNITY_HOST_CAT(unityHostTest_, __LINE__)(void)
+
+#define UNITY_HOST_CHECK_INT(relation, cond, expected, actual, message)                                                 \
+    do                                                                                                                   \
+    {                                                                                                                    \
+        const intmax_t unityExpected_ = (intmax_t)(expected);                                                            \
+        const intmax_t unityActual_ = (intmax_t)(actual);                                                                \
+        if (!(cond))                                                                                                     \
+        {                                                                                                                \
+            unityHostFailInt(__FILE__, __LINE__, message, relation, unityExpected_, unityActual_);                      \
+        }                                                                                                                \
+    } while (0)
+
+#define TEST_FAIL_MESSAGE(message) unityHostFail(__FILE__, __LINE__, message, nullptr)
+#define TEST_FAIL() TEST_FAIL_MESSAGE(nullptr)
+#define TEST_IGNORE_MESSAGE(message) unityHostIgnore(__FILE__, __LINE__, message)
+#define TEST_IGNORE() TEST_IGNORE_MESSAGE(nullptr)
+
+#define TEST_ASSERT_TRUE_MESSAGE(condition, message)                               \
+    do                                                                             \
+    {                                                                              \
+        if (!(condition))                                                          \
+        {                                                                          \
+            unityHostFail(__FILE__, __LINE__, message, "Expected TRUE Was FALSE"); \
+        }                                                                          \
+    } while (0)
+#define TEST_ASSERT_FALSE_MESSAGE(condition, message)                              \
+    do                                                                             \
+    {                                                                              \
+        if (condition)                                                             \
+        {                                                                          \
+            unityHostFail(__FILE__, __LINE__, message, "Expected FALSE Was TRUE"); \
+        }                                                                          \
+    } while (0)
+#define TEST_ASSERT_MESSAGE(condition, message) TEST_ASSERT_TRUE_MESSAGE(condition, message)
+#define TEST_ASSERT(condition) TEST_ASSERT_TRUE_MESSAGE(condition, nullptr)
+#define TEST_ASSERT_TRUE(condition) TEST_ASSERT_TRUE_MESSAGE(condition, nullptr)
+#define TEST_ASSERT_FALSE(condition) TEST_ASSERT_FALSE_MESSAGE(condition, nullptr)
+#define TEST_ASSERT_NULL(pointer) TEST_ASSERT_TRUE_MESSAGE((pointer) == nullptr, "Expected NULL")
+#define TEST_ASSERT_NOT_NULL(pointer) TEST_ASSERT_TRUE_MESSAGE((pointer) != nullptr, "Expected Non-NULL")
+
+#define TEST_ASSERT_EQUAL_MESSAGE(expected, actual, message) \
+    UNITY_HOST_CHECK_INT("==", unityExpected_ == unityActual_, expected, actual, message)
+#define TEST_ASSERT_EQUAL(expected, actual) TEST_ASSERT_EQUAL_MESSAGE(expected, actual, nullptr)
+#define TEST_ASSERT_EQUAL_INT(expected, actual) TEST_ASSERT_EQUAL_MESSAGE(expected, actual, nullptr)
+#define TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected, actual, message) \
+    TEST_ASSERT_EQUAL_MESSAGE((uint32_t)(expected), (uint32_t)(actual), message)
+#define TEST_ASSERT_EQUAL_UINT32(expected, actual) TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected, actual, nullptr)
+#define TEST_ASSERT_NOT_EQUAL_MESSAGE(expected, actual, message) \
+    UNITY_HOST_CHECK_INT("!=", unityExpected_ != unityActual_, expected, actual, message)
+#define TEST_ASSERT_NOT_EQUAL(expected, actual) TEST_ASSERT_NOT_EQUAL_MESSAGE(expected, actual, nullptr)
+#define TEST_ASSERT_EQUAL_PTR(expected, actual) \
+    TEST_ASSERT_EQUAL_MESSAGE((intptr_t)(const void *)(expected), (intptr_t)(const void *)(actual), "Pointers differ")
+
+// Unity order: threshold first, then the actual value
+#define TEST_ASSERT_GREATER_THAN_MESSAGE(threshold, actual, message) \
+    UNITY_HOST_CHECK_INT(">", unityActual_ > unityExpected_, threshold, actual, message)
+#define TEST_ASSERT_GREATER_THAN(threshold, actual) TEST_ASSERT_GREATER_THAN_MESSAGE(threshold, actual, nullptr)
+#define TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(threshold, actual, message) \
+    UNITY_HOST_CHECK_INT(">=", unityActual_ >= unityExpected_, threshold, actual, message)
+#define TEST_ASSERT_GREATER_OR_EQUAL(threshold, actual) TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(threshold, actual, nullptr)
+#define TEST_ASSERT_GREATER_OR_EQUAL_UINT32(threshold, actual) \
+    TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE((uint32_t)(threshold), (uint32_t)(actual), nullptr)
+#define TEST_ASSERT_LESS_THAN_MESSAGE(threshold, actual, message) \
+    UNITY_HOST_CHECK_INT("<", unityActual_ < unityExpected_, threshold, actual, message)
+#define TEST_ASSERT_LESS_THAN(threshold, actual) TEST_ASSERT_LESS_THAN_MESSAGE(threshold, actual, nullptr)
+#define TEST_ASSERT_LESS_THAN_UINT32(threshold, actual) \
+    TEST_ASSERT_LESS_THAN_MESSAGE((uint32_t)(threshold), (uint32_t)(actual), nullptr)
+#define TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(threshold, actual, message) \
+    UNITY_HOST_CHECK_INT("<=", unityActual_ <= unityExpected_, threshold, actual, message)
+#define TEST_ASSERT_LESS_OR_EQUAL(threshold, actual) TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(threshold, actual, nullptr)
+#define TEST_ASSERT_LESS_OR_EQUAL_UINT32(threshold, actual) \
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE((uint32_t)(threshold), (uint32_t)(actual), nullptr)
+
+#define TEST_ASSERT_EQUAL_STRING_MESSAGE(expected, actual, message)                                   \
+    do                                                                                                \
+    {                                                                                                 \
+        const char *unityExpected_ = (expected);                                                      \
+        const char *unityActual_ = (actual);                                                          \
+        if (!unityExpected_ || !unityActual_ || std::strcmp(unityExpected_, unityActual_) != 0)       \
+        {                                                                                             \
+            unityHostFail(__FILE__, __LINE__, message, unityActual_ ? unityActual_ : "(null string)"); \
+        }                                                                                             \
+    } while (0)
+#define TEST_ASSERT_EQUAL_STRING(expected, actual) TEST_ASSERT_EQUAL_STRING_MESSAGE(expected, actual, nullptr)
+
+// Unity's default float precision: 0.00001 of the expected value
+#define TEST_ASSERT_EQUAL_FLOAT(expected, actual)                                                                   \
+    do                                                                                                             \
+    {                                                                                                              \
+        const float unityExpected_ = (expected);                                                                   \
+        const float unityActual_ = (actual);                                                                       \
+        if (!(std::fabs(unityExpected_ - unityActual_) <= std::fabs(unityExpected_) * 0.00001f))                  \
+        {                                                                                                          \
+            unityHostFail(__FILE__, __LINE__, nullptr, "Values Not Within Delta");                                 \
+        }                                                                                                          \
+    } while (0)
@@ -0,0 +1,101 @@
+/*
+ * espHost.cpp
+ *  esp_log, esp_timer, esp_cpu, heap_caps and version functions of the host shim.
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+static const auto s_start = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+static std::mutex s_logMutex;
+
+void esp_log_write(esp_log_level_t, const char *, const char *format, ...)
+{
+    std::lock_guard<std::mutex> lock(s_logMutex); // keep lines of concurrent tasks apart
+    va_list args;
+    va_start(args, format);
+    std::vprintf(format, args);
+    va_end(args);
+    std::fflush(stdout);
+}
+
+void esp_log_level_set(const char *, esp_log_level_t)
+{
+}
+
+uint32_t esp_cpu_get_cycle_count(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<uint32_t>(__rdtsc());
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_start).count());
+#endif
+}
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void)
+{
+    static const uint32_t ticksPerUs = [] {
+        const int64_t t0 = esp_timer_get_time();
+        const uint32_t c0 = esp_cpu_get_cycle_count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const uint32_t cycles = esp_cpu_get_cycle_count() - c0;
+        const int64_t us = esp_timer_get_time() - t0;
+        return static_cast<uint32_t>(us > 0 ? cycles / us : 0);
+    }();
+    return ticksPerUs;
+}
+
+const char *esp_get_idf_version(void)
+{
+    return "host";
+}
+
+void *heap_caps_malloc(size_t size, uint32_t)
+{
+    return std::malloc(size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    std::free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t)
+{
+    constexpr size_t nominalHeap = 1u << 30;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const size_t used = mallinfo2().uordblks;
+    return used < nominalHeap ? nominalHeap - used : 0;
+#else
+    return nominalHeap;
+#endif
+}
@@ -0,0 +1,498 @@
+/*
+ * freertosHost.cpp
+ *  FreeRTOS tasks, semaphores, event groups, task notifications and critical sections on top of std::thread.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+//-- time
+
+static const auto s_start = std::chrono::steady_clock::now();
+
+static std::chrono::steady_clock::duration ticksToDuration(TickType_t ticks)
+{
+    return std::chrono::milliseconds(static_cast<int64_t>(ticks) * 1000 / configTICK_RATE_HZ);
+}
+
+// Wait on `cv` until `ready` or timeout. Returns `ready()`.
+template <class Pred>
+static bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticks, Pred ready)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, ticksToDuration(ticks), ready);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - s_start;
+    return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() * configTICK_RATE_HZ / 1000);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    if (xTicksToDelay == 0)
+    {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(ticksToDuration(xTicksToDelay));
+}
+
+void taskYIELD(void)
+{
+    std::this_thread::yield();
+}
+
+//-- tasks
+
+struct HostTask
+{
+    std::string name;
+    UBaseType_t priority{0};
+    BaseType_t core{tskNO_AFFINITY};
+
+    std::mutex notifyMutex;
+    std::condition_variable notifyCv;
+    uint32_t notifyValue{0};
+    bool notifyPending{false};
+
+    void *tls[configNUM_THREAD_LOCAL_STORAGE_POINTERS]{};
+    TlsDeleteCallbackFunction_t tlsDelete[configNUM_THREAD_LOCAL_STORAGE_POINTERS]{};
+};
+
+// Thrown by vTaskDelete(nullptr), caught by the task's thread function
+struct HostTaskExit
+{
+};
+
+static thread_local HostTask *s_currentTask = nullptr;
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (!s_currentTask)
+    {
+        // the main thread, or a thread not created by xTaskCreate
+        s_currentTask = new HostTask{};
+        s_currentTask->name = "main";
+        s_currentTask->priority = 1;
+    }
+    return s_currentTask;
+}
+
+static void runTlsDeleteCallbacks(HostTask *task)
+{
+    for (int i = 0; i < configNUM_THREAD_LOCAL_STORAGE_POINTERS; i++)
+    {
+        if (task->tlsDelete[i])
+        {
+            task->tlsDelete[i](i, task->tls[i]);
+        }
+    }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t, void *pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID)
+{
+    // Task handles are never freed: other tasks may still hold them (i.e. as subscribers) after the task is gone.
+    HostTask *task = new HostTask{};
+    task->name = pcName ? pcName : "";
+    task->priority = uxPriority;
+    task->core = (xCoreID == tskNO_AFFINITY) ? tskNO_AFFINITY : xCoreID % portNUM_PROCESSORS;
+    if (pvCreatedTask)
+    {
+        *pvCreatedTask = task;
+    }
+    std::thread([task, pvTaskCode, pvParameters] {
+        s_currentTask = task;
+        const unsigned cpus = std::thread::hardware_concurrency();
+        if (task->core != tskNO_AFFINITY && cpus > 1)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(static_cast<unsigned>(task->core) % cpus, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+        try
+        {
+            pvTaskCode(pvParameters);
+            std::fprintf(stderr, "task '%s' returned without vTaskDelete(NULL)\n", task->name.c_str());
+            std::abort(); // like FreeRTOS
+        }
+        catch (const HostTaskExit &)
+        {
+        }
+        runTlsDeleteCallbacks(task);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters,
+                       UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask)
+{
+    return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    if (xTaskToDelete && xTaskToDelete != s_currentTask)
+    {
+        std::fprintf(stderr, "vTaskDelete() of another task is not supported on the host\n");
+        std::abort();
+    }
+    throw HostTaskExit{};
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery)
+{
+    HostTask *task = xTaskToQuery ? xTaskToQuery : xTaskGetCurrentTaskHandle();
+    return &task->name[0];
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask)
+{
+    return (xTask ? xTask : xTaskGetCurrentTaskHandle())->priority;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    const BaseType_t core = xTaskGetCurrentTaskHandle()->core;
+    if (core != tskNO_AFFINITY)
+    {
+        return core;
+    }
+    const int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu % portNUM_PROCESSORS;
+}
+
+BaseType_t xPortInIsrContext(void)
+{
+    return pdFALSE;
+}
+
+//-- task notifications
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction)
+{
+    HostTask &task = *xTaskToNotify;
+    std::lock_guard<std::mutex> lock(task.notifyMutex);
+    switch (eAction)
+    {
+    case eNoAction:
+        break;
+    case eSetBits:
+        task.notifyValue |= ulValue;
+        break;
+    case eIncrement:
+        task.notifyValue++;
+        break;
+    case eSetValueWithOverwrite:
+        task.notifyValue = ulValue;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (task.notifyPending)
+        {
+            return pdFAIL;
+        }
+        task.notifyValue = ulValue;
+        break;
+    }
+    task.notifyPending = true;
+    task.notifyCv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    return xTaskNotify(xTaskToNotify, 0, eIncrement);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue,
+                           TickType_t xTicksToWait)
+{
+    HostTask &task = *xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task.notifyMutex);
+    if (!task.notifyPending)
+    {
+        task.notifyValue &= ~ulBitsToClearOnEntry;
+    }
+    if (!waitFor(task.notifyCv, lock, xTicksToWait, [&task] { return task.notifyPending; }))
+    {
+        if (pulNotificationValue)
+        {
+            *pulNotificationValue = task.notifyValue;
+        }
+        return pdFALSE;
+    }
+    if (pulNotificationValue)
+    {
+        *pulNotificationValue = task.notifyValue;
+    }
+    task.notifyValue &= ~ulBitsToClearOnExit;
+    task.notifyPending = false;
+    return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    HostTask &task = *xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task.notifyMutex);
+    waitFor(task.notifyCv, lock, xTicksToWait, [&task] { return task.notifyValue != 0; });
+    const uint32_t value = task.notifyValue;
+    if (value)
+    {
+        task.notifyValue = xClearCountOnExit ? 0 : value - 1;
+    }
+    task.notifyPending = false;
+    return value;
+}
+
+//-- thread local storage pointers
+
+void *pvTaskGetThreadLocalStoragePointer(TaskHandle_t xTaskToQuery, BaseType_t xIndex)
+{
+    HostTask *task = xTaskToQuery ? xTaskToQuery : xTaskGetCurrentTaskHandle();
+    return (xIndex >= 0 && xIndex < configNUM_THREAD_LOCAL_STORAGE_POINTERS) ? task->tls[xIndex] : nullptr;
+}
+
+void vTaskSetThreadLocalStoragePointerAndDelCallback(TaskHandle_t xTaskToSet, BaseType_t xIndex, void *pvValue,
+                                                     TlsDeleteCallbackFunction_t pvDelCallback)
+{
+    HostTask *task = xTaskToSet ? xTaskToSet : xTaskGetCurrentTaskHandle();
+    if (xIndex >= 0 && xIndex < configNUM_THREAD_LOCAL_STORAGE_POINTERS)
+    {
+        task->tls[xIndex] = pvValue;
+        task->tlsDelete[xIndex] = pvDelCallback;
+    }
+}
+
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t xTaskToSet, BaseType_t xIndex, void *pvValue)
+{
+    vTaskSetThreadLocalStoragePointerAndDelCallback(xTaskToSet, xIndex, pvValue, nullptr);
+}
+
+//-- critical sections
+
+static std::atomic<uint32_t> s_nextThreadId{1};
+static thread_local uint32_t s_threadId = 0;
+
+static uint32_t threadId()
+{
+    if (!s_threadId)
+    {
+        s_threadId = s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    }
+    return s_threadId;
+}
+
+void vPortMuxInitialize(portMUX_TYPE *mux)
+{
+    mux->owner.store(0, std::memory_order_relaxed);
+    mux->count = 0;
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    const uint32_t self = threadId();
+    if (mux->owner.load(std::memory_order_relaxed) == self)
+    {
+        mux->count++;
+        return;
+    }
+    uint32_t expected = 0;
+    while (!mux->owner.compare_exchange_weak(expected, self, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        expected = 0;
+        std::this_thread::yield(); // the holder may be preempted, unlike on the target
+    }
+    mux->count = 1;
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    if (--mux->count == 0)
+    {
+        mux->owner.store(0, std::memory_order_release);
+    }
+}
+
+//-- semaphores
+
+struct HostSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    UBaseType_t count{0};
+    UBaseType_t max{1};
+    bool isMutex{false};
+    HostTask *holder{nullptr};
+};
+
+static SemaphoreHandle_t createSemaphore(UBaseType_t max, UBaseType_t initial, bool isMutex)
+{
+    HostSemaphore *s = new HostSemaphore{};
+    s->max = max;
+    s->count = initial;
+    s->isMutex = isMutex;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return createSemaphore(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *)
+{
+    return xSemaphoreCreateMutex();
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return createSemaphore(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *)
+{
+    return xSemaphoreCreateBinary();
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    return createSemaphore(uxMaxCount, uxInitialCount, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount, StaticSemaphore_t *)
+{
+    return xSemaphoreCreateCounting(uxMaxCount, uxInitialCount);
+}
+
+SemaphoreHandle_t xQueueCreateCountingSemaphore(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    return xSemaphoreCreateCounting(uxMaxCount, uxInitialCount);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    delete xSemaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    HostSemaphore &s = *xSemaphore;
+    std::unique_lock<std::mutex> lock(s.mutex);
+    if (!waitFor(s.cv, lock, xBlockTime, [&s] { return s.count > 0; }))
+    {
+        return pdFALSE;
+    }
+    s.count--;
+    if (s.isMutex)
+    {
+        s.holder = xTaskGetCurrentTaskHandle();
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    HostSemaphore &s = *xSemaphore;
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.count >= s.max)
+    {
+        return pdFALSE;
+    }
+    s.count++;
+    s.holder = nullptr;
+    s.cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(xSemaphore);
+}
+
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t xSemaphore)
+{
+    std::lock_guard<std::mutex> lock(xSemaphore->mutex);
+    return xSemaphore->holder;
+}
+
+//-- event groups
+
+struct HostEventGroup
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    EventBits_t bits{0};
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return new HostEventGroup{};
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup)
+{
+    delete xEventGroup;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet)
+{
+    std::lock_guard<std::mutex> lock(xEventGroup->mutex);
+    xEventGroup->bits |= uxBitsToSet;
+    xEventGroup->cv.notify_all();
+    return xEventGroup->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToClear)
+{
+    std::lock_guard<std::mutex> lock(xEventGroup->mutex);
+    const EventBits_t before = xEventGroup->bits;
+    xEventGroup->bits &= ~uxBitsToClear;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup)
+{
+    std::lock_guard<std::mutex> lock(xEventGroup->mutex);
+    return xEventGroup->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToWaitFor, BaseType_t xClearOnExit,
+                                BaseType_t xWaitForAllBits, TickType_t xTicksToWait)
+{
+    HostEventGroup &g = *xEventGroup;
+    std::unique_lock<std::mutex> lock(g.mutex);
+    auto satisfied = [&] {
+        return xWaitForAllBits ? (g.bits & uxBitsToWaitFor) == uxBitsToWaitFor : (g.bits & uxBitsToWaitFor) != 0;
+    };
+    const bool ok = waitFor(g.cv, lock, xTicksToWait, satisfied);
+    const EventBits_t bits = g.bits;
+    if (ok && xClearOnExit)
+    {
+        g.bits &= ~uxBitsToWaitFor;
+    }
+    return bits;
+}
@@ -0,0 +1,279 @@
+/*
+ * nvsHost.cpp
+ *  In-memory NVS of the host shim: namespaces of blobs in std::maps, behind one mutex.
+ *  Writes are visible right away, nvs_commit() only checks the handle (like the target, where commit is a no-op
+ *  for blobs). Enforces the name length limits and read-only handles, so misuse fails as on the target.
+ */
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "esp_err.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+namespace
+{
+    using Blob = std::vector<uint8_t>;
+    using Namespace = std::map<std::string, Blob>;
+
+    struct Handle
+    {
+        std::string ns;
+        bool writable;
+    };
+
+    std::mutex s_mutex;
+    bool s_initialized = false;
+    std::map<std::string, Namespace> s_namespaces;
+    std::map<nvs_handle_t, Handle> s_handles;
+    nvs_handle_t s_nextHandle = 1;
+
+    bool validName(const char *name)
+    {
+        return name && name[0] && strlen(name) < NVS_KEY_NAME_MAX_SIZE;
+    }
+
+    // s_mutex held
+    esp_err_t findHandle(nvs_handle_t handle, bool write, Namespace *&ns)
+    {
+        auto it = s_handles.find(handle);
+        if (it == s_handles.end())
+        {
+            return ESP_ERR_NVS_INVALID_HANDLE;
+        }
+        if (write && !it->second.writable)
+        {
+            return ESP_ERR_NVS_READ_ONLY;
+        }
+        ns = &s_namespaces[it->second.ns];
+        return ESP_OK;
+    }
+} // namespace
+
+struct nvs_opaque_iterator_t
+{
+    std::vector<nvs_entry_info_t> entries;
+    std::size_t index;
+};
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_NVS_NOT_INITIALIZED:
+        return "ESP_ERR_NVS_NOT_INITIALIZED";
+    case ESP_ERR_NVS_NOT_FOUND:
+        return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_NOT_ENOUGH_SPACE:
+        return "ESP_ERR_NVS_NOT_ENOUGH_SPACE";
+    case ESP_ERR_NVS_READ_ONLY:
+        return "ESP_ERR_NVS_READ_ONLY";
+    case ESP_ERR_NVS_INVALID_HANDLE:
+        return "ESP_ERR_NVS_INVALID_HANDLE";
+    case ESP_ERR_NVS_KEY_TOO_LONG:
+        return "ESP_ERR_NVS_KEY_TOO_LONG";
+    case ESP_ERR_NVS_INVALID_NAME:
+        return "ESP_ERR_NVS_INVALID_NAME";
+    case ESP_ERR_NVS_INVALID_LENGTH:
+        return "ESP_ERR_NVS_INVALID_LENGTH";
+    default:
+        return "ERROR";
+    }
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_namespaces.clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_initialized)
+    {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (!validName(namespace_name))
+    {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    const bool writable = (open_mode == NVS_READWRITE);
+    if (!writable && s_namespaces.find(namespace_name) == s_namespaces.end())
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    s_namespaces[namespace_name];
+    *out_handle = s_nextHandle++;
+    s_handles[*out_handle] = Handle{namespace_name, writable};
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_handles.erase(handle);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Namespace *ns = nullptr;
+    esp_err_t err = findHandle(handle, true, ns);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    if (!validName(key))
+    {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(value);
+    (*ns)[key] = Blob(bytes, bytes + length);
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Namespace *ns = nullptr;
+    esp_err_t err = findHandle(handle, false, ns);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    auto it = ns->find(key);
+    if (it == ns->end())
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value)
+    {
+        if (*length < it->second.size())
+        {
+            *length = it->second.size();
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, it->second.data(), it->second.size());
+    }
+    *length = it->second.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Namespace *ns = nullptr;
+    esp_err_t err = findHandle(handle, true, ns);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    return ns->erase(key) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Namespace *ns = nullptr;
+    esp_err_t err = findHandle(handle, true, ns);
+    if (err == ESP_OK)
+    {
+        ns->clear();
+    }
+    return err;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Namespace *ns = nullptr;
+    return findHandle(handle, true, ns);
+}
+
+esp_err_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type, nvs_iterator_t *output_iterator)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    *output_iterator = nullptr;
+    if (!s_initialized)
+    {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (strcmp(part_name, NVS_DEFAULT_PART_NAME) != 0 || (type != NVS_TYPE_BLOB && type != NVS_TYPE_ANY))
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    auto *it = new nvs_opaque_iterator_t{};
+    for (const auto &ns : s_namespaces)
+    {
+        if (namespace_name && ns.first != namespace_name)
+        {
+            continue;
+        }
+        for (const auto &entry : ns.second)
+        {
+            nvs_entry_info_t info{};
+            strncpy(info.namespace_name, ns.first.c_str(), sizeof(info.namespace_name) - 1);
+            strncpy(info.key, entry.first.c_str(), sizeof(info.key) - 1);
+            info.type = NVS_TYPE_BLOB;
+            it->entries.push_back(info);
+        }
+    }
+    if (it->entries.empty())
+    {
+        delete it;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *output_iterator = it;
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_next(nvs_iterator_t *iterator)
+{
+    if (!iterator || !*iterator)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (++(*iterator)->index >= (*iterator)->entries.size())
+    {
+        delete *iterator;
+        *iterator = nullptr;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *out_info)
+{
+    if (!iterator || !out_info)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_info = iterator->entries[iterator->index];
+    return ESP_OK;
+}
+
+void nvs_release_iterator(nvs_iterator_t iterator)
+{
+    delete iterator;
+}
@@ -0,0 +1,103 @@
+/*
+ * unityHost.cpp
+ *  TEST_CASE registry and runner of the host build, with Unity's output format.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "unity.h"
+
+struct UnityHostTest
+{
+    const char *name;
+    const char *tags;
+    const char *file;
+    int line;
+    UnityHostTestFunction fn;
+};
+
+struct UnityHostFailure
+{
+};
+struct UnityHostIgnored
+{
+};
+
+static std::vector<UnityHostTest> &tests()
+{
+    static std::vector<UnityHostTest> s_tests; // constructed on first use, registration runs during static init
+    return s_tests;
+}
+
+UnityHostRegistration::UnityHostRegistration(const char *name, const char *tags, const char *file, int line, UnityHostTestFunction fn)
+{
+    tests().push_back(UnityHostTest{name, tags, file, line, fn});
+}
+
+static const char *baseName(const char *path)
+{
+    const char *slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+void unityHostFail(const char *file, int line, const char *message, const char *detail)
+{
+    std::printf("%s:%d:FAIL: %s%s%s\n", baseName(file), line, detail ? detail : "", (detail && message) ? ". " : "",
+                message ? message : "");
+    throw UnityHostFailure{};
+}
+
+void unityHostFailInt(const char *file, int line, const char *message, const char *relation, intmax_t expected, intmax_t actual)
+{
+    char detail[96];
+    std::snprintf(detail, sizeof(detail), "Expected %s %jd Was %jd", relation, expected, actual);
+    unityHostFail(file, line, message, detail);
+}
+
+void unityHostIgnore(const char *file, int line, const char *message)
+{
+    std::printf("%s:%d:IGNORE: %s\n", baseName(file), line, message ? message : "");
+    throw UnityHostIgnored{};
+}
+
+void unityHostList()
+{
+    for (const UnityHostTest &t : tests())
+    {
+        std::printf("\"%s\" %s\n", t.name, t.tags);
+    }
+}
+
+int unityHostRun(const char *include, const char *exclude)
+{
+    int run = 0, failures = 0, ignored = 0;
+    for (const UnityHostTest &t : tests())
+    {
+        if ((include && !std::strstr(t.tags, include) && std::strcmp(t.name, include) != 0) ||
+            (exclude && std::strstr(t.tags, exclude)))
+        {
+            continue;
+        }
+        std::printf("Running %s...\n", t.name);
+        std::fflush(stdout);
+        run++;
+        try
+        {
+            t.fn();
+            std::printf("%s:%d:%s:PASS\n", baseName(t.file), t.line, t.name);
+        }
+        catch (const UnityHostFailure &)
+        {
+            failures++;
+        }
+        catch (const UnityHostIgnored &)
+        {
+            ignored++;
+        }
+        std::fflush(stdout);
+    }
+    std::printf("\n-----------------------\n%d Tests %d Failures %d Ignored\n%s\n", run, failures, ignored, failures ? "FAIL" : "OK");
+    return failures;
+}